@@ -15,7 +15,7 @@ public class FunWithCubes : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(new[]
 		{
-			"ProceduralMeshComponent"
+			"ProceduralMeshComponent", "RenderCore", "RHI"
 		});
 
 		// Uncomment if you are using Slate UI
@@ -2,6 +2,12 @@
 
 #include "ChunkLoader.h"
 
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/App.h"
+#include "RenderCore.h"
+#include "RHI.h"
 #include "TerrainChunk.h"
 
 AChunkLoader::AChunkLoader()
@@ -12,81 +18,656 @@ AChunkLoader::AChunkLoader()
 void AChunkLoader::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
 	if (ensure(ChunkClass != nullptr))
 	{
 		ATerrainChunk* DefaultChunk = ChunkClass->GetDefaultObject<ATerrainChunk>();
 
-		ChunkWidth = DefaultChunk->GetScale() * static_cast<double>(DefaultChunk->GetResolution());
-		MaxChunkHeight = DefaultChunk->GetMaxHeight();
+		ChunkSizeInVoxels = {
+			DefaultChunk->GetResolution(),
+			DefaultChunk->GetResolution(),
+			DefaultChunk->GetChunkHeight(),
+		};
+		ChunkWidth = DefaultChunk->GetScale() * static_cast<double>(ChunkSizeInVoxels.X);
+		ChunkHeight = DefaultChunk->GetScale() * static_cast<double>(ChunkSizeInVoxels.Z);
+		NumVerticalChunks = FMath::DivideAndRoundUp(WorldHeight, ChunkSizeInVoxels.Z);
 	}
-	
+
 	if (bRandomSeed)
 	{
 		RngSeed = FMath::Rand();
 	}
+
+	EffectiveRenderDistance = bAdaptiveRenderDistance
+		? FMath::Clamp(RenderDistance, MinRenderDistance, FMath::Max(MinRenderDistance, MaxRenderDistance))
+		: RenderDistance;
+	TimeSinceLowered = RaiseCooldown;
+}
+
+void AChunkLoader::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (const auto& [PlayerController, Pawn] : ObservedPlayerControllers)
+	{
+		if (PlayerController.IsValid())
+		{
+			PlayerController->OnPossessedPawnChanged.RemoveDynamic(this, &AChunkLoader::HandlePossessedPawnChanged);
+		}
+	}
+	ObservedPlayerControllers.Empty();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AChunkLoader::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	
-	if (APlayerController* Controller = GetWorld()->GetFirstPlayerController())
+
+	if (bObservePlayerPawns)
+	{
+		UpdatePlayerControllers();
+	}
+	UpdateObservers();
+
+	if (bRescorePendingChunks)
+	{
+		RescorePendingChunks();
+	}
+
+	if (bPendingChunksDirty || !NewPendingChunks.IsEmpty())
+	{
+		MergePendingChunks();
+	}
+
+	if (bAdaptiveRenderDistance)
+	{
+		UpdateAdaptiveRenderDistance();
+	}
+
+	LoadPendingChunks();
+}
+
+void AChunkLoader::RegisterObserver(AActor* Actor, int32 ObserverRenderDistance)
+{
+	if (Actor == nullptr)
+	{
+		return;
+	}
+
+	UnobservedPlayerPawns.Remove(Actor);
+
+	// References of an existing observer will be moved to the new render distance on the next update.
+	FChunkObserver& Observer = Observers.FindOrAdd(Actor);
+	Observer.RenderDistance = ObserverRenderDistance;
+}
+
+void AChunkLoader::UnregisterObserver(AActor* Actor)
+{
+	FChunkObserver Observer;
+	if (Observers.RemoveAndCopyValue(Actor, Observer))
+	{
+		if (Observer.bPlayerPawn)
+		{
+			UnobservedPlayerPawns.Add(Actor);
+		}
+		ReleaseObserverReferences(Observer);
+	}
+}
+
+void AChunkLoader::UpdatePlayerControllers()
+{
+	const UWorld* World = GetWorld();
+
+	// Player controllers rarely come and go, so the controller list is only walked when their number changes.
+	if (World->GetNumPlayerControllers() != ObservedPlayerControllers.Num())
 	{
-		if (APawn* Pawn = Controller->GetPawnOrSpectator())
+		for (auto It = ObservedPlayerControllers.CreateIterator(); It; ++It)
 		{
-			const FVector PawnLocation = Pawn->GetActorLocation();
-			const FIntVector CurrentPlayerChunk3D(PawnLocation / ChunkWidth);
-			const FIntVector2 CurrentPlayerChunk2D = { CurrentPlayerChunk3D.X, CurrentPlayerChunk3D.Y };
-			if (CurrentPlayerChunk2D != LastPlayerChunk || LoadedChunks.IsEmpty())
+			if (!It.Key().IsValid())
 			{
-				LastPlayerChunk = CurrentPlayerChunk2D;
-
-				// Load new chunks that come within the render distance from the player.
-				FIntVector2 CurrentChunkCoord;
-				for (CurrentChunkCoord.X = CurrentPlayerChunk2D.X - RenderDistance;
-					CurrentChunkCoord.X < CurrentPlayerChunk2D.X + RenderDistance;
-					CurrentChunkCoord.X++) 
-				{
-					for (CurrentChunkCoord.Y = CurrentPlayerChunk2D.Y - RenderDistance;
-						CurrentChunkCoord.Y < CurrentPlayerChunk2D.Y + RenderDistance;
-						CurrentChunkCoord.Y++)
-					{
-						if (!LoadedChunks.Contains(CurrentChunkCoord))
-						{
-							const FVector ChunkLocation = {
-								CurrentChunkCoord.X * ChunkWidth,
-								CurrentChunkCoord.Y * ChunkWidth,
-								0.0,
-							};
-
-							if (
-								ATerrainChunk* NewChunk = GetWorld()->SpawnActor<ATerrainChunk>(
-									ChunkClass, ChunkLocation, FRotator::ZeroRotator)
-							) {
-								NewChunk->SetRngSeed(RngSeed);
-								NewChunk->GenerateChunk();
-								LoadedChunks.Add(CurrentChunkCoord, NewChunk);
-							}
-						}
-					}
-				}
-				
-				// Unload old chunks that are too far away from the player.
-				TArray<FIntVector2> LoadedChunkCoords;
-				LoadedChunks.GetKeys(LoadedChunkCoords);
-				for (const FIntVector2 ChunkCoord : LoadedChunkCoords)
-				{
-					if (
-						FMath::Abs(ChunkCoord.X - LastPlayerChunk.X) > RenderDistance
-						|| FMath::Abs(ChunkCoord.Y - LastPlayerChunk.Y) > RenderDistance
-					) {
-						GetWorld()->DestroyActor(LoadedChunks[ChunkCoord]);
-						LoadedChunks.Remove(ChunkCoord);
-					}
-				}
+				RemovePlayerPawnObserver(It.Value().Get());
+				It.RemoveCurrent();
 			}
 		}
+
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			ObservePlayerController(It->Get());
+		}
+	}
+
+	// Spectating doesn't change the possessed pawn, so players without one are checked for a spectator every tick.
+	for (const auto& [PlayerController, Pawn] : ObservedPlayerControllers)
+	{
+		if (PlayerController.IsValid() && PlayerController->GetPawn() == nullptr)
+		{
+			UpdatePlayerControllerPawn(PlayerController.Get());
+		}
+	}
+}
+
+void AChunkLoader::ObservePlayerController(APlayerController* PlayerController)
+{
+	if (PlayerController != nullptr && !ObservedPlayerControllers.Contains(PlayerController))
+	{
+		ObservedPlayerControllers.Add(PlayerController);
+		PlayerController->OnPossessedPawnChanged.AddUniqueDynamic(this, &AChunkLoader::HandlePossessedPawnChanged);
+		UpdatePlayerControllerPawn(PlayerController);
+	}
+}
+
+void AChunkLoader::UpdatePlayerControllerPawn(APlayerController* PlayerController)
+{
+	TWeakObjectPtr<APawn>& ObservedPawn = ObservedPlayerControllers.FindOrAdd(PlayerController);
+	APawn* Pawn = PlayerController->GetPawnOrSpectator();
+	if (ObservedPawn.Get() != Pawn)
+	{
+		RemovePlayerPawnObserver(ObservedPawn.Get());
+		AddPlayerPawnObserver(Pawn);
+		ObservedPawn = Pawn;
+	}
+}
+
+void AChunkLoader::AddPlayerPawnObserver(APawn* Pawn)
+{
+	if (Pawn != nullptr && !UnobservedPlayerPawns.Contains(Pawn) && !Observers.Contains(Pawn))
+	{
+		Observers.Add(Pawn).bPlayerPawn = true;
+	}
+}
+
+void AChunkLoader::RemovePlayerPawnObserver(APawn* Pawn)
+{
+	FChunkObserver* Observer = Observers.Find(Pawn);
+	if (Observer != nullptr && Observer->bPlayerPawn)
+	{
+		ReleaseObserverReferences(*Observer);
+		Observers.Remove(Pawn);
+	}
+}
+
+void AChunkLoader::HandlePossessedPawnChanged(APawn* OldPawn, APawn* NewPawn)
+{
+	// The event doesn't say which controller it comes from, but there are only a few of them to check.
+	for (const auto& [PlayerController, Pawn] : ObservedPlayerControllers)
+	{
+		if (PlayerController.IsValid())
+		{
+			UpdatePlayerControllerPawn(PlayerController.Get());
+		}
+	}
+}
+
+void AChunkLoader::UpdateObservers()
+{
+	for (auto It = Observers.CreateIterator(); It; ++It)
+	{
+		FChunkObserver& Observer = It.Value();
+		const AActor* Actor = It.Key().Get();
+		if (Actor == nullptr)
+		{
+			ReleaseObserverReferences(Observer);
+			It.RemoveCurrent();
+			continue;
+		}
+
+		const FIntVector CentreChunk = WorldLocationToChunkCoords(Actor->GetActorLocation());
+		const int32 Distance = Observer.RenderDistance >= 0 ? Observer.RenderDistance : EffectiveRenderDistance;
+		if (CentreChunk == Observer.CentreChunk && Distance == Observer.ReferencedRenderDistance)
+		{
+			continue;
+		}
+
+		// Only chunks that have left or entered the observer's area change their reference counts. References are
+		// added first, so that chunks that stay within range of other observers aren't unloaded in between.
+		ReferenceChunksAround(CentreChunk, Distance, Observer.CentreChunk, Observer.ReferencedRenderDistance);
+		ReleaseChunksAround(Observer.CentreChunk, Observer.ReferencedRenderDistance, CentreChunk, Distance);
+		Observer.CentreChunk = CentreChunk;
+		Observer.ReferencedRenderDistance = Distance;
+		bRescorePendingChunks = true;
+	}
+}
+
+template <typename FunctorType>
+void AChunkLoader::ForEachChunkAround(
+	const FIntVector& Centre,
+	int32 Distance,
+	const FIntVector& ExcludedCentre,
+	int32 ExcludedDistance,
+	FunctorType&& Functor
+) const {
+	if (Distance < 0)
+	{
+		return;
+	}
+
+	FIntVector ChunkCoords;
+	for (ChunkCoords.X = Centre.X - Distance; ChunkCoords.X <= Centre.X + Distance; ++ChunkCoords.X)
+	{
+		for (ChunkCoords.Y = Centre.Y - Distance; ChunkCoords.Y <= Centre.Y + Distance; ++ChunkCoords.Y)
+		{
+			int32 MinChunkZ, MaxChunkZ;
+			if (!GetColumnWithinRenderDistance(Centre, Distance, ChunkCoords.X, ChunkCoords.Y, MinChunkZ, MaxChunkZ))
+			{
+				continue;
+			}
+
+			// The excluded area is a sphere as well, so it covers a single contiguous range of each column.
+			int32 ExcludedMinChunkZ, ExcludedMaxChunkZ;
+			if (!GetColumnWithinRenderDistance(ExcludedCentre, ExcludedDistance, ChunkCoords.X, ChunkCoords.Y, ExcludedMinChunkZ, ExcludedMaxChunkZ))
+			{
+				ExcludedMinChunkZ = MaxChunkZ + 1;
+				ExcludedMaxChunkZ = MaxChunkZ;
+			}
+
+			for (ChunkCoords.Z = MinChunkZ; ChunkCoords.Z <= FMath::Min(MaxChunkZ, ExcludedMinChunkZ - 1); ++ChunkCoords.Z)
+			{
+				Functor(ChunkCoords);
+			}
+			for (ChunkCoords.Z = FMath::Max(MinChunkZ, ExcludedMaxChunkZ + 1); ChunkCoords.Z <= MaxChunkZ; ++ChunkCoords.Z)
+			{
+				Functor(ChunkCoords);
+			}
+		}
+	}
+}
+
+void AChunkLoader::ReferenceChunksAround(
+	const FIntVector& Centre,
+	int32 Distance,
+	const FIntVector& ExcludedCentre,
+	int32 ExcludedDistance
+) {
+	ForEachChunkAround(Centre, Distance, ExcludedCentre, ExcludedDistance, [this](const FIntVector& ChunkCoords)
+	{
+		AddChunkReference(ChunkCoords);
+	});
+}
+
+void AChunkLoader::ReleaseChunksAround(
+	const FIntVector& Centre,
+	int32 Distance,
+	const FIntVector& ExcludedCentre,
+	int32 ExcludedDistance
+) {
+	ForEachChunkAround(Centre, Distance, ExcludedCentre, ExcludedDistance, [this](const FIntVector& ChunkCoords)
+	{
+		ReleaseChunkReference(ChunkCoords);
+	});
+}
+
+void AChunkLoader::ReleaseObserverReferences(FChunkObserver& Observer)
+{
+	ReleaseChunksAround(Observer.CentreChunk, Observer.ReferencedRenderDistance, Observer.CentreChunk, -1);
+	Observer.ReferencedRenderDistance = -1;
+	bRescorePendingChunks = true;
+}
+
+void AChunkLoader::AddChunkReference(const FIntVector& ChunkCoords)
+{
+	++ChunkReferenceCounts.FindOrAdd(ChunkCoords, 0);
+	if (LoadedChunks.Contains(ChunkCoords))
+	{
+		return;
+	}
+
+	// Chunks in the sky are resolved right away, so that they don't count towards the generation backlog.
+	if (IsChunkAboveTerrain(ChunkCoords))
+	{
+		LoadedChunks.Add(ChunkCoords, nullptr);
+		return;
+	}
+
+	// The chunk is queued when pending chunks are rescored, once all observers have been moved.
+	PendingChunkPriorities.FindOrAdd(ChunkCoords, UnscoredPriority);
+}
+
+void AChunkLoader::ReleaseChunkReference(const FIntVector& ChunkCoords)
+{
+	int32* ReferenceCount = ChunkReferenceCounts.Find(ChunkCoords);
+	if (!ensure(ReferenceCount != nullptr) || --(*ReferenceCount) > 0)
+	{
+		return;
+	}
+
+	ChunkReferenceCounts.Remove(ChunkCoords);
+
+	ATerrainChunk* Chunk = nullptr;
+	if (LoadedChunks.RemoveAndCopyValue(ChunkCoords, Chunk))
+	{
+		UnloadChunk(Chunk);
+	}
+	else if (PendingChunkPriorities.Remove(ChunkCoords) > 0)
+	{
+		// The chunk is still queued, so its entry has to be dropped from the queue.
+		bPendingChunksDirty = true;
+	}
+}
+
+double AChunkLoader::CalculateChunkPriority(const FIntVector& ChunkCoords) const
+{
+	// Observers with a shorter render distance of their own don't need the chunk, even if they're closer to it. The
+	// nearest observer of all is only a fallback for chunks right on the edge of the render distance.
+	double NearestDistanceSquared = UnscoredPriority;
+	double NearestReferencingDistanceSquared = UnscoredPriority;
+	for (const auto& [Actor, Observer] : Observers)
+	{
+		if (Observer.ReferencedRenderDistance < 0)
+		{
+			continue;
+		}
+
+		const double DistanceSquared = GetChunkDistanceSquared(ChunkCoords, Observer.CentreChunk);
+		NearestDistanceSquared = FMath::Min(NearestDistanceSquared, DistanceSquared);
+		if (DistanceSquared <= FMath::Square(Observer.ReferencedRenderDistance * ChunkWidth))
+		{
+			NearestReferencingDistanceSquared = FMath::Min(NearestReferencingDistanceSquared, DistanceSquared);
+		}
+	}
+	if (NearestReferencingDistanceSquared != UnscoredPriority)
+	{
+		NearestDistanceSquared = NearestReferencingDistanceSquared;
+	}
+
+	const int32* ReferenceCount = ChunkReferenceCounts.Find(ChunkCoords);
+	return NearestDistanceSquared / FMath::Max(ReferenceCount != nullptr ? *ReferenceCount : 1, 1);
+}
+
+void AChunkLoader::RescorePendingChunks()
+{
+	for (auto& [ChunkCoords, Priority] : PendingChunkPriorities)
+	{
+		const double NewPriority = CalculateChunkPriority(ChunkCoords);
+		if (NewPriority == Priority)
+		{
+			continue;
+		}
+
+		// The chunk's earlier queue entry, if there is one, becomes stale.
+		if (Priority != UnscoredPriority)
+		{
+			bPendingChunksDirty = true;
+		}
+		Priority = NewPriority;
+		NewPendingChunks.Add({ ChunkCoords, NewPriority });
 	}
+
+	bRescorePendingChunks = false;
+}
+
+void AChunkLoader::UpdateAdaptiveRenderDistance()
+{
+	// The wall time of a frame includes waiting for vsync, so a frame locked to the display's refresh rate would
+	// always seem to take the whole budget. Use the busy time of whichever thread (or the GPU) limits the frame rate
+	// instead.
+	const uint32 BusyCycles = FMath::Max(
+		FMath::Max(GGameThreadTime, GRenderThreadTime),
+		FMath::Max(GRHIThreadTime, RHIGetGPUFrameCycles())
+	);
+	const double FrameTime = FPlatformTime::ToSeconds(BusyCycles);
+	SmoothedFrameTime = SmoothedFrameTime > 0.0
+		? FMath::Lerp(SmoothedFrameTime, FrameTime, SmoothingFactor)
+		: FrameTime;
+
+	// Intervals are measured in real time, unaffected by time dilation.
+	const double DeltaTime = FApp::GetDeltaTime();
+	TimeSinceAdjustment += DeltaTime;
+	TimeSinceLowered += DeltaTime;
+	if (TimeSinceAdjustment < AdjustmentInterval)
+	{
+		return;
+	}
+	TimeSinceAdjustment = 0.0;
+
+	const double FrameTimeBudget = TargetFrameTime / 1000.0;
+	const double MeshMemoryBudget = MaxMeshMemory * 1024.0 * 1024.0;
+	const double BacklogSeconds = PendingChunkPriorities.IsEmpty()
+		? 0.0
+		: PendingChunkPriorities.Num() / FMath::Max(SmoothedChunksPerSecond, UE_KINDA_SMALL_NUMBER);
+
+	int32 NewRenderDistance = EffectiveRenderDistance;
+	ERenderDistanceChangeReason Reason = ERenderDistanceChangeReason::None;
+	if (SmoothedFrameTime > FrameTimeBudget)
+	{
+		NewRenderDistance--;
+		Reason = ERenderDistanceChangeReason::FrameTime;
+	}
+	else if (BacklogSeconds > MaxGenerationBacklog)
+	{
+		NewRenderDistance--;
+		Reason = ERenderDistanceChangeReason::GenerationBacklog;
+	}
+	else if (ResidentMeshMemoryBytes > MeshMemoryBudget)
+	{
+		NewRenderDistance--;
+		Reason = ERenderDistanceChangeReason::MeshMemory;
+	}
+	else if (TimeSinceLowered >= RaiseCooldown)
+	{
+		// The number of loaded chunks grows with the cube of the distance, so check whether the memory taken
+		// after raising it would still leave some headroom.
+		const double ProjectedMeshMemory = ResidentMeshMemoryBytes
+			* FMath::Cube(static_cast<double>(EffectiveRenderDistance + 1) / EffectiveRenderDistance);
+		if (
+			SmoothedFrameTime < FrameTimeBudget * RaiseThreshold
+			&& BacklogSeconds < MaxGenerationBacklog * RaiseThreshold
+			&& ProjectedMeshMemory < MeshMemoryBudget * RaiseThreshold
+		) {
+			NewRenderDistance++;
+			Reason = ERenderDistanceChangeReason::Headroom;
+		}
+	}
+
+	NewRenderDistance = FMath::Clamp(NewRenderDistance, MinRenderDistance, FMath::Max(MinRenderDistance, MaxRenderDistance));
+	if (NewRenderDistance == EffectiveRenderDistance)
+	{
+		return;
+	}
+
+	if (NewRenderDistance < EffectiveRenderDistance)
+	{
+		TimeSinceLowered = 0.0;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Render distance changed from %d to %d (%s). Frame time: %.2f ms, backlog: %.2f s, mesh memory: %.1f MB."),
+		EffectiveRenderDistance, NewRenderDistance, *UEnum::GetValueAsString(Reason),
+		SmoothedFrameTime * 1000.0, BacklogSeconds, ResidentMeshMemoryBytes / (1024.0 * 1024.0));
+
+	const int32 OldRenderDistance = EffectiveRenderDistance;
+	EffectiveRenderDistance = NewRenderDistance;
+	LastRenderDistanceChangeReason = Reason;
+	OnRenderDistanceChanged.Broadcast(OldRenderDistance, NewRenderDistance, Reason);
+}
+
+FIntVector AChunkLoader::ChunkCoordsToVoxelOrigin(const FIntVector& ChunkCoords) const
+{
+	return {
+		ChunkCoords.X * ChunkSizeInVoxels.X,
+		ChunkCoords.Y * ChunkSizeInVoxels.Y,
+		ChunkCoords.Z * ChunkSizeInVoxels.Z,
+	};
+}
+
+bool AChunkLoader::IsChunkAboveTerrain(const FIntVector& ChunkCoords) const
+{
+	return ChunkClass != nullptr
+		&& ChunkClass->GetDefaultObject<ATerrainChunk>()->IsAboveTerrain(ChunkCoordsToVoxelOrigin(ChunkCoords));
 }
 
+FIntVector AChunkLoader::WorldLocationToChunkCoords(const FVector& Location) const
+{
+	return {
+		FMath::FloorToInt32(Location.X / ChunkWidth),
+		FMath::FloorToInt32(Location.Y / ChunkWidth),
+		FMath::FloorToInt32(Location.Z / ChunkHeight),
+	};
+}
+
+double AChunkLoader::GetChunkDistanceSquared(const FIntVector& ChunkCoords, const FIntVector& CentreChunkCoords) const
+{
+	// Chunks aren't necessarily cubes, so the distance is measured in world units rather than in chunk counts.
+	const FIntVector Offset = ChunkCoords - CentreChunkCoords;
+	const FVector WorldOffset = {
+		Offset.X * ChunkWidth,
+		Offset.Y * ChunkWidth,
+		Offset.Z * ChunkHeight,
+	};
+	return WorldOffset.SizeSquared();
+}
+
+bool AChunkLoader::GetColumnWithinRenderDistance(
+	const FIntVector& Centre,
+	int32 Distance,
+	int32 ChunkX,
+	int32 ChunkY,
+	int32& OutMinChunkZ,
+	int32& OutMaxChunkZ
+) const {
+	if (Distance < 0)
+	{
+		return false;
+	}
+
+	// Same metric as `GetChunkDistanceSquared`, solved for the vertical offset.
+	const double HorizontalDistanceSquared =
+		(FMath::Square<double>(ChunkX - Centre.X) + FMath::Square<double>(ChunkY - Centre.Y)) * FMath::Square(ChunkWidth);
+	const double RemainingDistanceSquared = FMath::Square(Distance * ChunkWidth) - HorizontalDistanceSquared;
+	if (RemainingDistanceSquared < 0.0)
+	{
+		return false;
+	}
+
+	const int32 VerticalDistance = FMath::FloorToInt32(FMath::Sqrt(RemainingDistanceSquared) / ChunkHeight);
+	OutMinChunkZ = FMath::Max(Centre.Z - VerticalDistance, 0);
+	OutMaxChunkZ = FMath::Min(Centre.Z + VerticalDistance, NumVerticalChunks - 1);
+	return OutMinChunkZ <= OutMaxChunkZ;
+}
+
+bool AChunkLoader::IsPendingChunkStale(const FPendingChunk& PendingChunk) const
+{
+	// Only the entry with the latest priority of a chunk is valid. Should a chunk's priority return to an earlier
+	// value, the duplicate entry is dropped once the first one is loaded and removes the chunk from the map.
+	const double* QueuedPriority = PendingChunkPriorities.Find(PendingChunk.ChunkCoords);
+	return QueuedPriority == nullptr || *QueuedPriority != PendingChunk.Priority;
+}
+
+void AChunkLoader::MergePendingChunks()
+{
+	const auto IsStale = [this](const FPendingChunk& PendingChunk) { return IsPendingChunkStale(PendingChunk); };
+
+	if (bPendingChunksDirty)
+	{
+		// Keeps the order of the remaining entries.
+		PendingChunks.RemoveAll(IsStale);
+		bPendingChunksDirty = false;
+	}
+
+	NewPendingChunks.RemoveAllSwap(IsStale);
+	if (NewPendingChunks.IsEmpty())
+	{
+		return;
+	}
+
+	// Only the newly queued chunks are sorted, then merged into the queue, which is sorted already. The chunk to
+	// load next ends up last, so that it can be popped off the queue.
+	NewPendingChunks.Sort([](const FPendingChunk& A, const FPendingChunk& B)
+	{
+		return A.Priority > B.Priority;
+	});
+
+	TArray<FPendingChunk> MergedChunks;
+	MergedChunks.Reserve(PendingChunks.Num() + NewPendingChunks.Num());
+	int32 QueuedIndex = 0;
+	int32 NewIndex = 0;
+	while (QueuedIndex < PendingChunks.Num() && NewIndex < NewPendingChunks.Num())
+	{
+		MergedChunks.Add(PendingChunks[QueuedIndex].Priority >= NewPendingChunks[NewIndex].Priority
+			? PendingChunks[QueuedIndex++]
+			: NewPendingChunks[NewIndex++]);
+	}
+	MergedChunks.Append(PendingChunks.GetData() + QueuedIndex, PendingChunks.Num() - QueuedIndex);
+	MergedChunks.Append(NewPendingChunks.GetData() + NewIndex, NewPendingChunks.Num() - NewIndex);
+
+	PendingChunks = MoveTemp(MergedChunks);
+	NewPendingChunks.Reset();
+}
+
+void AChunkLoader::LoadPendingChunks()
+{
+	if (PendingChunks.IsEmpty())
+	{
+		return;
+	}
+
+	int32 NumLoaded = 0;
+	int32 NumGenerated = 0;
+	while (NumLoaded < MaxChunksLoadedPerTick && !PendingChunks.IsEmpty())
+	{
+		const FPendingChunk PendingChunk = PendingChunks.Pop(false);
+		if (!IsPendingChunkStale(PendingChunk))
+		{
+			PendingChunkPriorities.Remove(PendingChunk.ChunkCoords);
+			NumGenerated += LoadChunk(PendingChunk.ChunkCoords) ? 1 : 0;
+			++NumLoaded;
+		}
+	}
+
+	// Generation rate is measured only while chunks are being meshed, as it's meaningless otherwise. Chunks rejected
+	// without meshing are much cheaper, so counting them would overestimate how quickly the backlog can be cleared.
+	if (NumGenerated == 0)
+	{
+		return;
+	}
+
+	const double ChunksPerSecond = NumGenerated / FMath::Max(FApp::GetDeltaTime(), UE_SMALL_NUMBER);
+	SmoothedChunksPerSecond = SmoothedChunksPerSecond > 0.0
+		? FMath::Lerp(SmoothedChunksPerSecond, ChunksPerSecond, SmoothingFactor)
+		: ChunksPerSecond;
+}
+
+bool AChunkLoader::LoadChunk(const FIntVector& ChunkCoords)
+{
+	if (!ensure(ChunkClass != nullptr))
+	{
+		return false;
+	}
+
+	const ATerrainChunk* DefaultChunk = ChunkClass->GetDefaultObject<ATerrainChunk>();
+	const FIntVector VoxelOrigin = ChunkCoordsToVoxelOrigin(ChunkCoords);
+
+	// Voxels are generated before the chunk actor is spawned, so that chunks without any visible faces (e.g. deep
+	// underground, away from any caves, or entirely under water) never get spawned and don't occupy any memory.
+	const TArray<EVoxelType> Voxels = DefaultChunk->GenerateVoxels(VoxelOrigin, RngSeed);
+	if (!DefaultChunk->HasVisibleFaces(Voxels))
+	{
+		LoadedChunks.Add(ChunkCoords, nullptr);
+		return false;
+	}
+
+	const FVector ChunkLocation = {
+		ChunkCoords.X * ChunkWidth,
+		ChunkCoords.Y * ChunkWidth,
+		ChunkCoords.Z * ChunkHeight,
+	};
+
+	if (
+		ATerrainChunk* NewChunk = GetWorld()->SpawnActor<ATerrainChunk>(
+			ChunkClass, ChunkLocation, FRotator::ZeroRotator)
+	) {
+		NewChunk->SetRngSeed(RngSeed);
+		NewChunk->GenerateChunk(Voxels);
+		LoadedChunks.Add(ChunkCoords, NewChunk);
+		ResidentMeshMemoryBytes += NewChunk->GetMeshMemoryBytes();
+		return true;
+	}
+
+	return false;
+}
+
+void AChunkLoader::UnloadChunk(ATerrainChunk* Chunk)
+{
+	if (Chunk != nullptr)
+	{
+		ResidentMeshMemoryBytes -= Chunk->GetMeshMemoryBytes();
+		GetWorld()->DestroyActor(Chunk);
+	}
+}
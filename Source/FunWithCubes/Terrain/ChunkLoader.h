@@ -6,6 +6,50 @@
 #include "GameFramework/Actor.h"
 #include "ChunkLoader.generated.h"
 
+// Why the adaptive render distance was last changed.
+UENUM(BlueprintType)
+enum class ERenderDistanceChangeReason : uint8
+{
+	None,
+
+	// Lowered because the smoothed frame time exceeded the target.
+	FrameTime,
+
+	// Lowered because chunks were requested faster than they could be generated.
+	GenerationBacklog,
+
+	// Lowered because loaded chunk meshes exceeded the memory budget.
+	MeshMemory,
+
+	// Raised because all of the above were comfortably within their budgets.
+	Headroom,
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnRenderDistanceChanged, int32, OldRenderDistance, int32, NewRenderDistance, ERenderDistanceChangeReason, Reason);
+
+// State of an actor around which chunks are kept loaded.
+struct FChunkObserver
+{
+	// Render distance specific to this observer. Negative values make it follow the loader's render distance.
+	int32 RenderDistance = -1;
+
+	// Whether the observer is a player pawn registered automatically by the loader.
+	bool bPlayerPawn = false;
+
+	// Area for which the observer currently holds chunk references.
+	FIntVector CentreChunk = { 0, 0, 0 };
+	int32 ReferencedRenderDistance = -1;
+};
+
+// Chunk waiting to be loaded.
+struct FPendingChunk
+{
+	FIntVector ChunkCoords;
+
+	// Lower values are loaded first.
+	double Priority;
+};
+
 UCLASS()
 class FUNWITHCUBES_API AChunkLoader : public AActor
 {
@@ -15,36 +59,237 @@ public:
 	AChunkLoader();
 
 	virtual void Tick(float DeltaTime) override;
-	
+
+	// Keeps chunks loaded around the given actor, in addition to those around other observers. Chunks in areas seen
+	// by several observers are only loaded once. A negative render distance makes the observer follow the loader's
+	// (possibly adaptive) render distance.
+	UFUNCTION(BlueprintCallable, Category = "World Generation")
+	void RegisterObserver(AActor* Actor, int32 ObserverRenderDistance = -1);
+
+	// Stops loading chunks around the given actor. Player pawns unregistered this way aren't registered again
+	// automatically, until they're explicitly registered.
+	UFUNCTION(BlueprintCallable, Category = "World Generation")
+	void UnregisterObserver(AActor* Actor);
+
+	int32 GetEffectiveRenderDistance() const { return EffectiveRenderDistance; }
+	ERenderDistanceChangeReason GetLastRenderDistanceChangeReason() const { return LastRenderDistanceChangeReason; }
+
+public:
+	// Called whenever the adaptive controller changes the effective render distance.
+	UPROPERTY(BlueprintAssignable, Category = "World Generation|Adaptive Render Distance")
+	FOnRenderDistanceChanged OnRenderDistanceChanged;
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+protected: // Helper functions
+	FIntVector WorldLocationToChunkCoords(const FVector& Location) const;
+	FIntVector ChunkCoordsToVoxelOrigin(const FIntVector& ChunkCoords) const;
+
+	// Whether the chunk would only contain air, which is cheap enough to check without queueing the chunk.
+	bool IsChunkAboveTerrain(const FIntVector& ChunkCoords) const;
+	double GetChunkDistanceSquared(const FIntVector& ChunkCoords, const FIntVector& CentreChunkCoords) const;
+
+	// Finds the vertical range of chunks in the given column that lie within the render distance around the centre.
+	// Returns false if there are none.
+	bool GetColumnWithinRenderDistance(const FIntVector& Centre, int32 Distance, int32 ChunkX, int32 ChunkY, int32& OutMinChunkZ, int32& OutMaxChunkZ) const;
+
+	// Starts observing player controllers which have appeared since the last update, and stops observing ones which
+	// no longer exist. Game mode events can't be used for this, as they're only raised on the server.
+	void UpdatePlayerControllers();
+
+	// Observes the pawn (or spectator) of the player, and any pawn it possesses later on.
+	void ObservePlayerController(class APlayerController* PlayerController);
+	void UpdatePlayerControllerPawn(class APlayerController* PlayerController);
+	void AddPlayerPawnObserver(class APawn* Pawn);
+	void RemovePlayerPawnObserver(class APawn* Pawn);
+
+	UFUNCTION()
+	void HandlePossessedPawnChanged(class APawn* OldPawn, class APawn* NewPawn);
+
+	// Moves chunk references of observers which have changed chunks or render distance, and drops observers whose
+	// actors no longer exist.
+	void UpdateObservers();
+
+	// Calls the functor for every chunk within the render distance around the given centre, except those which are
+	// also within the render distance around `ExcludedCentre`. Works column by column, so only chunks that are
+	// actually passed to the functor are visited.
+	template <typename FunctorType>
+	void ForEachChunkAround(const FIntVector& Centre, int32 Distance, const FIntVector& ExcludedCentre, int32 ExcludedDistance, FunctorType&& Functor) const;
+
+	// Adds or releases references to chunks within the render distance around the given centre. Chunks which are
+	// also within the render distance around `ExcludedCentre` are skipped, so that moving an observer only touches
+	// chunks that have entered or left its area.
+	void ReferenceChunksAround(const FIntVector& Centre, int32 Distance, const FIntVector& ExcludedCentre, int32 ExcludedDistance);
+	void ReleaseChunksAround(const FIntVector& Centre, int32 Distance, const FIntVector& ExcludedCentre, int32 ExcludedDistance);
+	void ReleaseObserverReferences(FChunkObserver& Observer);
+
+	// Adds a reference to the chunk, marking it as pending if it isn't loaded yet. It's queued once its priority is
+	// calculated.
+	void AddChunkReference(const FIntVector& ChunkCoords);
+	void ReleaseChunkReference(const FIntVector& ChunkCoords);
+
+	// Chunks closer to their nearest observer have lower values. Chunks within the render distance of several
+	// observers have their priority scaled down by the number of observers, so that areas shared by players load
+	// sooner.
+	double CalculateChunkPriority(const FIntVector& ChunkCoords) const;
+
+	// Recalculates the priorities of all pending chunks after observers have moved, and queues the chunks whose
+	// priorities have changed again.
+	void RescorePendingChunks();
+
+	// Whether the queue entry belongs to a chunk which is no longer needed, or has been queued again since.
+	bool IsPendingChunkStale(const FPendingChunk& PendingChunk) const;
+
+	// Merges newly queued chunks into the sorted queue, dropping stale entries from it if there are any.
+	void MergePendingChunks();
+	void LoadPendingChunks();
+	// Returns true if the chunk has been generated and meshed, rather than found to have no visible faces.
+	bool LoadChunk(const FIntVector& ChunkCoords);
+	void UnloadChunk(class ATerrainChunk* Chunk);
+
+	// Measures recent performance and adjusts the effective render distance.
+	void UpdateAdaptiveRenderDistance();
 
 protected:
 	UPROPERTY(EditAnywhere, Category = "World Generation")
 	TSubclassOf<class ATerrainChunk> ChunkClass;
 
-	// Distance (units: chunk count) within which chunks will be generated in a square shape around the player.
+	// Distance (units: chunk width) within which chunks will be generated in a spherical shape around each observer.
+	// When the adaptive render distance is enabled, this is only the starting value.
 	UPROPERTY(EditAnywhere, Category = "World Generation")
 	int32 RenderDistance = 5;
 
+	// Whether the render distance should be adjusted at runtime based on the frame time, generation backlog,
+	// and memory taken by chunk meshes.
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance")
+	bool bAdaptiveRenderDistance = false;
+
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 1, UIMin = 1))
+	int32 MinRenderDistance = 3;
+
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 1, UIMin = 1))
+	int32 MaxRenderDistance = 16;
+
+	// Frame time (units: milliseconds) above which the render distance is lowered. Measured as the busy time of the
+	// slowest of the game, render and RHI threads and the GPU, so that waiting for vsync or a frame rate limit
+	// doesn't count towards it.
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 1, UIMin = 1))
+	double TargetFrameTime = 16.6;
+
+	// Time (units: seconds) it would take to generate all pending chunks at the recent generation rate, above which
+	// the render distance is lowered.
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 0, UIMin = 0))
+	double MaxGenerationBacklog = 3.0;
+
+	// Memory (units: megabytes) taken by meshes of loaded chunks, above which the render distance is lowered.
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 1, UIMin = 1))
+	double MaxMeshMemory = 1024.0;
+
+	// Fraction of each budget that must be left unused before the render distance is raised. Keeping it well below 1
+	// stops the distance from flipping back and forth between two values.
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 0, ClampMax = 1, UIMin = 0, UIMax = 1))
+	double RaiseThreshold = 0.7;
+
+	// Time (units: seconds) between consecutive adjustments of the render distance.
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 0, UIMin = 0))
+	double AdjustmentInterval = 1.0;
+
+	// Time (units: seconds) after lowering the render distance during which it won't be raised again.
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 0, UIMin = 0))
+	double RaiseCooldown = 10.0;
+
+	// Weight of the newest sample in the exponential moving averages of frame time and generation rate.
+	UPROPERTY(EditAnywhere, Category = "World Generation|Adaptive Render Distance", meta = (EditCondition = "bAdaptiveRenderDistance", ClampMin = 0, ClampMax = 1, UIMin = 0, UIMax = 1))
+	double SmoothingFactor = 0.05;
+
+	// Height of the world (units: blocks). Chunks are only generated between altitude 0 and this value.
+	UPROPERTY(EditAnywhere, Category = "World Generation", meta = (ClampMin = 1, UIMin = 1))
+	int32 WorldHeight = 512;
+
+	// Maximum number of chunks generated in a single frame. Chunks are generated synchronously on the game thread,
+	// so this bounds the time spent on generation per frame. Remaining chunks are generated in the following frames,
+	// nearest to the observers first.
+	UPROPERTY(EditAnywhere, Category = "World Generation", meta = (ClampMin = 1, UIMin = 1))
+	int32 MaxChunksLoadedPerTick = 8;
+
+	// Whether pawns possessed by players (or their spectators) are automatically registered as observers. Disable to
+	// only load chunks around observers registered explicitly.
+	UPROPERTY(EditAnywhere, Category = "World Generation")
+	bool bObservePlayerPawns = true;
+
 	// Whether the RNG seed will be randomised on every run.
 	UPROPERTY(EditAnywhere, Category = "World Generation")
 	bool bRandomSeed = false;
-	
+
 	// Seed for the random number generator used to generate the world.
 	UPROPERTY(EditAnywhere, Category = "World Generation", meta = (EditCondition = "!bRandomSeed"))
 	int32 RngSeed = 123457890;
-	
+
+	// Render distance currently in use.
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "World Generation|Adaptive Render Distance")
+	int32 EffectiveRenderDistance = 5;
+
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "World Generation|Adaptive Render Distance")
+	ERenderDistanceChangeReason LastRenderDistanceChangeReason = ERenderDistanceChangeReason::None;
+
+	// Performance measurements driving the adaptive render distance.
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "World Generation|Adaptive Render Distance")
+	double SmoothedFrameTime = 0.0;
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "World Generation|Adaptive Render Distance")
+	double SmoothedChunksPerSecond = 0.0;
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "World Generation|Adaptive Render Distance")
+	int64 ResidentMeshMemoryBytes = 0;
+
+	UPROPERTY(Transient)
+	double TimeSinceAdjustment = 0.0;
+	UPROPERTY(Transient)
+	double TimeSinceLowered = 0.0;
+
 	UPROPERTY(Transient)
 	double ChunkWidth = 3200.0;
 	UPROPERTY(Transient)
-	int32 MaxChunkHeight = 64;
-	
-	// Coordinates of the chunk in which the player pawn currently is.
+	double ChunkHeight = 3200.0;
+	UPROPERTY(Transient)
+	FIntVector ChunkSizeInVoxels = { 32, 32, 32 };
 	UPROPERTY(Transient)
-	FIntVector2 LastPlayerChunk = { 0, 0 };
+	int32 NumVerticalChunks = 16;
+
+	TMap<TWeakObjectPtr<AActor>, FChunkObserver> Observers;
+
+	// Player pawns which have been explicitly unregistered.
+	TSet<TWeakObjectPtr<AActor>> UnobservedPlayerPawns;
 
-	// Maps a loaded chunk to its coordinates.
+	// Player controllers whose pawns are observed, mapped to the pawn or spectator observed for each of them.
+	TMap<TWeakObjectPtr<class APlayerController>, TWeakObjectPtr<class APawn>> ObservedPlayerControllers;
+
+	// Number of observers within whose render distance each chunk lies. Chunks are loaded when this becomes
+	// positive and unloaded when it drops back to zero.
+	UPROPERTY(Transient)
+	TMap<FIntVector, int32> ChunkReferenceCounts;
+
+	// Maps a loaded chunk to its coordinates. Chunks which have been generated but don't have any visible faces
+	// (e.g. ones buried deep underground or floating in the sky) are mapped to null, so that they don't have
+	// to be spawned nor generated again.
 	UPROPERTY(Transient)
-	TMap<FIntVector2, class ATerrainChunk*> LoadedChunks;
+	TMap<FIntVector, class ATerrainChunk*> LoadedChunks;
+
+	// Chunks within the render distance of some observer that are yet to be loaded, mapped to the priority with
+	// which they've last been queued. Chunks which haven't been queued yet are mapped to `UnscoredPriority`.
+	TMap<FIntVector, double> PendingChunkPriorities;
+	static constexpr double UnscoredPriority = TNumericLimits<double>::Max();
+
+	// Queue of chunks to load, sorted so that the chunk to load next is the last one. May contain stale entries,
+	// which are skipped when they're reached.
+	TArray<FPendingChunk> PendingChunks;
+
+	// Chunks queued since the queue was last merged.
+	TArray<FPendingChunk> NewPendingChunks;
+
+	// Whether the queue contains entries of chunks which are no longer needed.
+	bool bPendingChunksDirty = false;
+
+	// Whether observers have moved since the priorities of pending chunks were last calculated.
+	bool bRescorePendingChunks = false;
 };
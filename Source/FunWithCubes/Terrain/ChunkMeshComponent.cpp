@@ -0,0 +1,314 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#include "ChunkMeshComponent.h"
+
+#include "LocalVertexFactory.h"
+#include "Materials/Material.h"
+#include "PrimitiveSceneProxy.h"
+#include "RenderingThread.h"
+#include "SceneInterface.h"
+#include "SceneManagement.h"
+#include "StaticMeshResources.h"
+
+// Uploads the indices straight from the shared section data, rather than keeping a copy of them like
+// `FDynamicMeshIndexBuffer32` does.
+class FChunkMeshIndexBuffer final : public FIndexBuffer
+{
+public:
+	explicit FChunkMeshIndexBuffer(FSharedChunkMeshSectionData InSectionData)
+		: SectionData(MoveTemp(InSectionData))
+	{
+	}
+
+	virtual void InitRHI(FRHICommandListBase& RHICmdList) override
+	{
+		const uint32 Size = SectionData->Indices.Num() * sizeof(uint32);
+		FRHIResourceCreateInfo CreateInfo(TEXT("FChunkMeshIndexBuffer"));
+		IndexBufferRHI = RHICmdList.CreateIndexBuffer(sizeof(uint32), Size, BUF_Static, CreateInfo);
+
+		void* Buffer = RHICmdList.LockBuffer(IndexBufferRHI, 0, Size, RLM_WriteOnly);
+		FMemory::Memcpy(Buffer, SectionData->Indices.GetData(), Size);
+		RHICmdList.UnlockBuffer(IndexBufferRHI);
+	}
+
+	int32 GetNumIndices() const { return SectionData->Indices.Num(); }
+
+private:
+	FSharedChunkMeshSectionData SectionData;
+};
+
+// Render resources of a single non-empty section.
+class FChunkMeshProxySection
+{
+public:
+	FChunkMeshProxySection(ERHIFeatureLevel::Type FeatureLevel, const FSharedChunkMeshSectionData& SectionData)
+		: IndexBuffer(SectionData)
+		, VertexFactory(FeatureLevel, "FChunkMeshProxySection")
+		, NumVertices(SectionData->GetNumVertices())
+	{
+	}
+
+	void InitResources(FRHICommandListBase& RHICmdList, const FChunkMeshSectionData& SectionData)
+	{
+		// The CPU copies made here are released as soon as the buffers are uploaded.
+		VertexBuffers.PositionVertexBuffer.Init(SectionData.Positions, false);
+		VertexBuffers.ColorVertexBuffer.InitFromColorArray(SectionData.Colors, sizeof(FColor), false);
+		VertexBuffers.StaticMeshVertexBuffer.Init(NumVertices, 1, false);
+		for (int32 VertexIndex = 0; VertexIndex < NumVertices; ++VertexIndex)
+		{
+			const FVector3f& Normal = SectionData.Normals[VertexIndex];
+			FVector3f TangentX, TangentY;
+			Normal.FindBestAxisVectors(TangentX, TangentY);
+			VertexBuffers.StaticMeshVertexBuffer.SetVertexTangents(VertexIndex, TangentX, TangentY, Normal);
+			VertexBuffers.StaticMeshVertexBuffer.SetVertexUV(VertexIndex, 0, FVector2f::ZeroVector);
+		}
+
+		VertexBuffers.PositionVertexBuffer.InitResource(RHICmdList);
+		VertexBuffers.StaticMeshVertexBuffer.InitResource(RHICmdList);
+		VertexBuffers.ColorVertexBuffer.InitResource(RHICmdList);
+		IndexBuffer.InitResource(RHICmdList);
+
+		FLocalVertexFactory::FDataType Data;
+		VertexBuffers.PositionVertexBuffer.BindPositionVertexBuffer(&VertexFactory, Data);
+		VertexBuffers.StaticMeshVertexBuffer.BindTangentVertexBuffer(&VertexFactory, Data);
+		VertexBuffers.StaticMeshVertexBuffer.BindPackedTexCoordVertexBuffer(&VertexFactory, Data);
+		VertexBuffers.StaticMeshVertexBuffer.BindLightMapVertexBuffer(&VertexFactory, Data, 0);
+		VertexBuffers.ColorVertexBuffer.BindColorVertexBuffer(&VertexFactory, Data);
+		VertexFactory.SetData(RHICmdList, Data);
+		VertexFactory.InitResource(RHICmdList);
+	}
+
+	void ReleaseResources()
+	{
+		VertexBuffers.PositionVertexBuffer.ReleaseResource();
+		VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+		VertexBuffers.ColorVertexBuffer.ReleaseResource();
+		IndexBuffer.ReleaseResource();
+		VertexFactory.ReleaseResource();
+	}
+
+	FStaticMeshVertexBuffers VertexBuffers;
+	FChunkMeshIndexBuffer IndexBuffer;
+	FLocalVertexFactory VertexFactory;
+	const int32 NumVertices;
+};
+
+class FChunkMeshSceneProxy final : public FPrimitiveSceneProxy
+{
+public:
+	explicit FChunkMeshSceneProxy(const UChunkMeshComponent* Component)
+		: FPrimitiveSceneProxy(Component)
+		, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetFeatureLevel()))
+		, NumSections(Component->GetNumSections())
+	{
+		TArray<FSharedChunkMeshSectionData> InitialSections;
+		Sections.SetNum(NumSections);
+		Materials.SetNum(NumSections);
+		for (int32 SectionIndex = 0; SectionIndex < NumSections; ++SectionIndex)
+		{
+			InitialSections.Add(Component->GetSectionData(SectionIndex));
+
+			UMaterialInterface* Material = Component->GetMaterial(SectionIndex);
+			Materials[SectionIndex] = Material != nullptr ? Material : UMaterial::GetDefaultMaterial(MD_Surface);
+		}
+
+		ENQUEUE_RENDER_COMMAND(InitChunkMeshSections)(
+			[this, InitialSections = MoveTemp(InitialSections)](FRHICommandListImmediate& RHICmdList)
+			{
+				for (int32 SectionIndex = 0; SectionIndex < InitialSections.Num(); ++SectionIndex)
+				{
+					SetSection_RenderThread(RHICmdList, SectionIndex, InitialSections[SectionIndex]);
+				}
+			});
+	}
+
+	virtual ~FChunkMeshSceneProxy() override
+	{
+		for (const TUniquePtr<FChunkMeshProxySection>& Section : Sections)
+		{
+			if (Section.IsValid())
+			{
+				Section->ReleaseResources();
+			}
+		}
+	}
+
+	// Number of sections the proxy has been created with. Only those can be updated in place, as new ones need
+	// their materials to be gathered on the game thread.
+	int32 GetNumSections() const { return NumSections; }
+
+	void SetSection_RenderThread(FRHICommandListBase& RHICmdList, int32 SectionIndex, const FSharedChunkMeshSectionData& SectionData)
+	{
+		check(IsInRenderingThread());
+
+		TUniquePtr<FChunkMeshProxySection>& Section = Sections[SectionIndex];
+		if (Section.IsValid())
+		{
+			Section->ReleaseResources();
+			Section.Reset();
+		}
+
+		if (SectionData.IsValid())
+		{
+			Section = MakeUnique<FChunkMeshProxySection>(GetScene().GetFeatureLevel(), SectionData);
+			Section->InitResources(RHICmdList, *SectionData);
+		}
+	}
+
+public: // Function overrides
+	virtual SIZE_T GetTypeHash() const override
+	{
+		static size_t UniquePointer;
+		return reinterpret_cast<size_t>(&UniquePointer);
+	}
+
+	virtual void GetDynamicMeshElements(
+		const TArray<const FSceneView*>& Views,
+		const FSceneViewFamily& ViewFamily,
+		uint32 VisibilityMap,
+		FMeshElementCollector& Collector
+	) const override {
+		for (int32 SectionIndex = 0; SectionIndex < NumSections; ++SectionIndex)
+		{
+			const FChunkMeshProxySection* Section = Sections[SectionIndex].Get();
+			if (Section == nullptr)
+			{
+				continue;
+			}
+
+			for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ++ViewIndex)
+			{
+				if ((VisibilityMap & (1 << ViewIndex)) == 0)
+				{
+					continue;
+				}
+
+				FMeshBatch& Mesh = Collector.AllocateMesh();
+				Mesh.VertexFactory = &Section->VertexFactory;
+				Mesh.MaterialRenderProxy = Materials[SectionIndex]->GetRenderProxy();
+				Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+				Mesh.Type = PT_TriangleList;
+				Mesh.DepthPriorityGroup = SDPG_World;
+				Mesh.bCanApplyViewModeOverrides = true;
+
+				FMeshBatchElement& BatchElement = Mesh.Elements[0];
+				BatchElement.IndexBuffer = &Section->IndexBuffer;
+				BatchElement.PrimitiveUniformBuffer = GetUniformBuffer();
+				BatchElement.FirstIndex = 0;
+				BatchElement.NumPrimitives = Section->IndexBuffer.GetNumIndices() / 3;
+				BatchElement.MinVertexIndex = 0;
+				BatchElement.MaxVertexIndex = Section->NumVertices - 1;
+
+				Collector.AddMesh(ViewIndex, Mesh);
+			}
+		}
+	}
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+	{
+		FPrimitiveViewRelevance Result;
+		Result.bDrawRelevance = IsShown(View);
+		Result.bShadowRelevance = IsShadowCast(View);
+		Result.bDynamicRelevance = true;
+		Result.bRenderInMainPass = ShouldRenderInMainPass();
+		Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
+		Result.bRenderCustomDepth = ShouldRenderCustomDepth();
+		MaterialRelevance.SetPrimitiveViewRelevance(Result);
+		return Result;
+	}
+
+	virtual bool CanBeOccluded() const override
+	{
+		return !MaterialRelevance.bDisableDepthTest;
+	}
+
+	virtual uint32 GetMemoryFootprint() const override
+	{
+		return sizeof(*this) + GetAllocatedSize();
+	}
+
+private:
+	FMaterialRelevance MaterialRelevance;
+	const int32 NumSections;
+	TArray<UMaterialInterface*> Materials;
+
+	// Null for sections without any geometry. Only accessed on the render thread.
+	TArray<TUniquePtr<FChunkMeshProxySection>> Sections;
+};
+
+void UChunkMeshComponent::SetSection(int32 SectionIndex, FChunkMeshSectionData&& SectionData)
+{
+	check(SectionIndex >= 0);
+	check(SectionData.Normals.Num() == SectionData.GetNumVertices() && SectionData.Colors.Num() == SectionData.GetNumVertices());
+
+	if (SectionIndex >= Sections.Num())
+	{
+		Sections.SetNum(SectionIndex + 1);
+		SectionBounds.SetNum(SectionIndex + 1);
+	}
+
+	FSharedChunkMeshSectionData SharedData;
+	if (!SectionData.IsEmpty())
+	{
+		SharedData = MakeShared<FChunkMeshSectionData, ESPMode::ThreadSafe>(MoveTemp(SectionData));
+	}
+	SectionBounds[SectionIndex] = SharedData.IsValid() ? FBox3f(SharedData->Positions) : FBox3f(ForceInit);
+	Sections[SectionIndex] = SharedData;
+
+	// Sections which the existing proxy knows about are swapped in place. Otherwise, the proxy has to be recreated
+	// to pick up the section's material.
+	FChunkMeshSceneProxy* Proxy = static_cast<FChunkMeshSceneProxy*>(SceneProxy);
+	if (Proxy != nullptr && SectionIndex < Proxy->GetNumSections())
+	{
+		ENQUEUE_RENDER_COMMAND(UpdateChunkMeshSection)(
+			[Proxy, SectionIndex, SharedData](FRHICommandListImmediate& RHICmdList)
+			{
+				Proxy->SetSection_RenderThread(RHICmdList, SectionIndex, SharedData);
+			});
+		UpdateBounds();
+		MarkRenderTransformDirty();
+	}
+	else
+	{
+		UpdateBounds();
+		MarkRenderStateDirty();
+	}
+}
+
+void UChunkMeshComponent::ClearAllSections()
+{
+	Sections.Empty();
+	SectionBounds.Empty();
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+FSharedChunkMeshSectionData UChunkMeshComponent::GetSectionData(int32 SectionIndex) const
+{
+	return Sections.IsValidIndex(SectionIndex) ? Sections[SectionIndex] : nullptr;
+}
+
+FPrimitiveSceneProxy* UChunkMeshComponent::CreateSceneProxy()
+{
+	return Sections.IsEmpty() ? nullptr : new FChunkMeshSceneProxy(this);
+}
+
+int32 UChunkMeshComponent::GetNumMaterials() const
+{
+	return Sections.Num();
+}
+
+FBoxSphereBounds UChunkMeshComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	FBox3f LocalBox(ForceInit);
+	for (const FBox3f& Bounds : SectionBounds)
+	{
+		LocalBox += Bounds;
+	}
+
+	if (!LocalBox.IsValid)
+	{
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0);
+	}
+	return FBoxSphereBounds(FBox(LocalBox)).TransformBy(LocalToWorld);
+}
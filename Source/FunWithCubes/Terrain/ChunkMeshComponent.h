@@ -0,0 +1,60 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/MeshComponent.h"
+
+#include "ChunkMeshComponent.generated.h"
+
+// Geometry of a single mesh section. The mesher writes it directly and `UChunkMeshComponent` takes it over by move,
+// without going through an intermediate vertex struct. On the render thread, positions and colours are copied into
+// the section's vertex buffers and normals are expanded into tangent frames, before everything is uploaded. The
+// component keeps its copy alive, so that the scene proxy can be recreated.
+struct FChunkMeshSectionData
+{
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Normals;
+	TArray<FColor> Colors;
+	TArray<uint32> Indices;
+
+	int32 GetNumVertices() const { return Positions.Num(); }
+	bool IsEmpty() const { return Indices.IsEmpty(); }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Positions.GetAllocatedSize() + Normals.GetAllocatedSize() + Colors.GetAllocatedSize() + Indices.GetAllocatedSize();
+	}
+};
+
+// Section data is immutable once handed over, so it's shared between the component and its scene proxy.
+using FSharedChunkMeshSectionData = TSharedPtr<const FChunkMeshSectionData, ESPMode::ThreadSafe>;
+
+// Minimal mesh component for terrain chunks. Unlike `UProceduralMeshComponent`, it doesn't convert the mesh into
+// its own vertex format, and replacing a section only rebuilds that section's render buffers instead of the whole
+// scene proxy.
+UCLASS(ClassGroup = Rendering, meta = (BlueprintSpawnableComponent))
+class FUNWITHCUBES_API UChunkMeshComponent : public UMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Replaces the geometry of the given section, taking ownership of its buffers. Empty data clears the section.
+	void SetSection(int32 SectionIndex, FChunkMeshSectionData&& SectionData);
+	void ClearAllSections();
+
+	int32 GetNumSections() const { return Sections.Num(); }
+	FSharedChunkMeshSectionData GetSectionData(int32 SectionIndex) const;
+
+public: // Function overrides
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+	virtual int32 GetNumMaterials() const override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+protected: // Data
+	// Null for sections without any geometry.
+	TArray<FSharedChunkMeshSectionData> Sections;
+
+	// Local bounds of each section, so that the component bounds don't have to be recalculated from the vertices.
+	TArray<FBox3f> SectionBounds;
+};
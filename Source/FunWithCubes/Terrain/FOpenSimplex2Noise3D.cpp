@@ -0,0 +1,195 @@
+// OpenSimplex2 noise based on K.jpg's reference implementation: https://github.com/KdotJPG/OpenSimplex2
+
+#include "FOpenSimplex2Noise3D.h"
+
+#include "Containers/StaticArray.h"
+
+namespace
+{
+	constexpr uint64 PrimeX = 0x5205402B9270C86FULL;
+	constexpr uint64 PrimeY = 0x598CD327003817B5ULL;
+	constexpr uint64 PrimeZ = 0x5BCC226E9FA0BACBULL;
+	constexpr uint64 HashMultiplier = 0x53A3F72DEEC546F5ULL;
+	constexpr int64 SeedFlip = -0x52D547B2E96ED629LL;
+
+	constexpr double FallbackRotation = 2.0 / 3.0;
+	constexpr int32 NumGradientsExponent = 8;
+	constexpr int32 NumGradients = 1 << NumGradientsExponent;
+	constexpr double Normalizer = 0.07969837668935331;
+	constexpr float RadiusSquared = 0.6f;
+
+	// Vertices of a rhombicuboctahedron, repeated to fill a table with a power-of-two number of entries.
+	const float* GetGradients()
+	{
+		static const TStaticArray<float, NumGradients * 4> Gradients = []
+		{
+			constexpr double A = 2.22474487139;
+			constexpr double B = 3.0862664687972017;
+			constexpr double C = 1.1721513422464978;
+			constexpr double BaseGradients[] = {
+				 A,  A, -1, 0,    A,  A,  1, 0,    B,  C,  0, 0,    C,  B,  0, 0,
+				-A,  A, -1, 0,   -A,  A,  1, 0,   -C,  B,  0, 0,   -B,  C,  0, 0,
+				-1, -A, -A, 0,    1, -A, -A, 0,    0, -B, -C, 0,    0, -C, -B, 0,
+				-1, -A,  A, 0,    1, -A,  A, 0,    0, -C,  B, 0,    0, -B,  C, 0,
+				-A, -A, -1, 0,   -A, -A,  1, 0,   -B, -C,  0, 0,   -C, -B,  0, 0,
+				-A, -1, -A, 0,   -A,  1, -A, 0,   -C,  0, -B, 0,   -B,  0, -C, 0,
+				-A, -1,  A, 0,   -A,  1,  A, 0,   -B,  0,  C, 0,   -C,  0,  B, 0,
+				-1,  A, -A, 0,    1,  A, -A, 0,    0,  C, -B, 0,    0,  B, -C, 0,
+				-1,  A,  A, 0,    1,  A,  A, 0,    0,  B,  C, 0,    0,  C,  B, 0,
+				 A, -A, -1, 0,    A, -A,  1, 0,    C, -B,  0, 0,    B, -C,  0, 0,
+				 A, -1, -A, 0,    A,  1, -A, 0,    B,  0, -C, 0,    C,  0, -B, 0,
+				 A, -1,  A, 0,    A,  1,  A, 0,    C,  0,  B, 0,    B,  0,  C, 0,
+			};
+			constexpr int32 NumBaseGradients = UE_ARRAY_COUNT(BaseGradients);
+
+			TStaticArray<float, NumGradients * 4> Result;
+			for (int32 i = 0; i < NumGradients * 4; i++)
+			{
+				Result[i] = static_cast<float>(BaseGradients[i % NumBaseGradients] / Normalizer);
+			}
+			return Result;
+		}();
+		return Gradients.GetData();
+	}
+
+	int32 FastRound(double X)
+	{
+		return X < 0 ? static_cast<int32>(X - 0.5) : static_cast<int32>(X + 0.5);
+	}
+
+	uint64 ToLatticeHash(int32 Coordinate, uint64 Prime)
+	{
+		return static_cast<uint64>(static_cast<int64>(Coordinate)) * Prime;
+	}
+}
+
+FOpenSimplex2Noise3D::FOpenSimplex2Noise3D(int32 Seed)
+	: BaseSeed(Seed)
+{
+	// Make sure the table is built before the provider is shared between threads.
+	GetGradients();
+}
+
+double FOpenSimplex2Noise3D::GetValue(FVector Position) const
+{
+	// Re-orient the cubic lattices via rotation to produce a familiar look.
+	const double R = FallbackRotation * (Position.X + Position.Y + Position.Z);
+	const float Noise = SampleUnrotated(R - Position.X, R - Position.Y, R - Position.Z);
+	return FMath::Clamp((Noise + 1.0) * 0.5, 0.0, 1.0);
+}
+
+float FOpenSimplex2Noise3D::SampleUnrotated(double XR, double YR, double ZR) const
+{
+	// Get base points and offsets.
+	const int32 XRB = FastRound(XR);
+	const int32 YRB = FastRound(YR);
+	const int32 ZRB = FastRound(ZR);
+	float XRI = static_cast<float>(XR - XRB);
+	float YRI = static_cast<float>(YR - YRB);
+	float ZRI = static_cast<float>(ZR - ZRB);
+
+	// -1 if positive, 1 if negative.
+	int32 XNSign = static_cast<int32>(-1.0f - XRI) | 1;
+	int32 YNSign = static_cast<int32>(-1.0f - YRI) | 1;
+	int32 ZNSign = static_cast<int32>(-1.0f - ZRI) | 1;
+
+	// Compute absolute values, using the above as a shortcut.
+	float AX0 = XNSign * -XRI;
+	float AY0 = YNSign * -YRI;
+	float AZ0 = ZNSign * -ZRI;
+
+	// Prime pre-multiplication for hash.
+	uint64 XRBP = ToLatticeHash(XRB, PrimeX);
+	uint64 YRBP = ToLatticeHash(YRB, PrimeY);
+	uint64 ZRBP = ToLatticeHash(ZRB, PrimeZ);
+
+	// Loop: pick an edge on each lattice copy.
+	int64 LatticeSeed = BaseSeed;
+	float Value = 0.0f;
+	float A = (RadiusSquared - XRI * XRI) - (YRI * YRI + ZRI * ZRI);
+	for (int32 Lattice = 0; ; Lattice++)
+	{
+		// Closest point on cube.
+		if (A > 0.0f)
+		{
+			Value += (A * A) * (A * A) * Grad(LatticeSeed, XRBP, YRBP, ZRBP, XRI, YRI, ZRI);
+		}
+
+		// Second-closest point.
+		if (AX0 >= AY0 && AX0 >= AZ0)
+		{
+			float B = A + AX0 + AX0;
+			if (B > 1.0f)
+			{
+				B -= 1.0f;
+				Value += (B * B) * (B * B) * Grad(
+					LatticeSeed, XRBP - ToLatticeHash(XNSign, PrimeX), YRBP, ZRBP, XRI + XNSign, YRI, ZRI);
+			}
+		}
+		else if (AY0 > AX0 && AY0 >= AZ0)
+		{
+			float B = A + AY0 + AY0;
+			if (B > 1.0f)
+			{
+				B -= 1.0f;
+				Value += (B * B) * (B * B) * Grad(
+					LatticeSeed, XRBP, YRBP - ToLatticeHash(YNSign, PrimeY), ZRBP, XRI, YRI + YNSign, ZRI);
+			}
+		}
+		else
+		{
+			float B = A + AZ0 + AZ0;
+			if (B > 1.0f)
+			{
+				B -= 1.0f;
+				Value += (B * B) * (B * B) * Grad(
+					LatticeSeed, XRBP, YRBP, ZRBP - ToLatticeHash(ZNSign, PrimeZ), XRI, YRI, ZRI + ZNSign);
+			}
+		}
+
+		// Break from loop if we're done, skipping updates below.
+		if (Lattice == 1)
+		{
+			break;
+		}
+
+		// Update absolute value.
+		AX0 = 0.5f - AX0;
+		AY0 = 0.5f - AY0;
+		AZ0 = 0.5f - AZ0;
+
+		// Update relative coordinate.
+		XRI = XNSign * AX0;
+		YRI = YNSign * AY0;
+		ZRI = ZNSign * AZ0;
+
+		// Update falloff.
+		A += (0.75f - AX0) - (AY0 + AZ0);
+
+		// Update prime for hash.
+		XRBP += XNSign < 0 ? PrimeX : 0;
+		YRBP += YNSign < 0 ? PrimeY : 0;
+		ZRBP += ZNSign < 0 ? PrimeZ : 0;
+
+		// Update the reverse sign indicators.
+		XNSign = -XNSign;
+		YNSign = -YNSign;
+		ZNSign = -ZNSign;
+
+		// And finally update the seed for the other lattice copy.
+		LatticeSeed ^= SeedFlip;
+	}
+
+	return Value;
+}
+
+float FOpenSimplex2Noise3D::Grad(int64 LatticeSeed, uint64 XRVP, uint64 YRVP, uint64 ZRVP, float DX, float DY, float DZ)
+{
+	uint64 Hash = (static_cast<uint64>(LatticeSeed) ^ XRVP) ^ (YRVP ^ ZRVP);
+	Hash *= HashMultiplier;
+	Hash ^= static_cast<uint64>(static_cast<int64>(Hash) >> (64 - NumGradientsExponent + 2));
+	const int32 GradientIndex = static_cast<int32>(Hash) & ((NumGradients - 1) << 2);
+
+	const float* Gradients = GetGradients();
+	return Gradients[GradientIndex | 0] * DX + Gradients[GradientIndex | 1] * DY + Gradients[GradientIndex | 2] * DZ;
+}
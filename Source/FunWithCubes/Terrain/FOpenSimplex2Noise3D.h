@@ -0,0 +1,23 @@
+// OpenSimplex2 noise based on K.jpg's reference implementation: https://github.com/KdotJPG/OpenSimplex2
+
+#pragma once
+
+#include "NoiseProvider.h"
+
+// Gradient noise on a rotated body-centred cubic lattice. Fewer directional artifacts than Perlin noise, and needs
+// no per-seed tables since the seed is mixed directly into lattice point hashes.
+struct FOpenSimplex2Noise3D : public INoiseProvider
+{
+public:
+	FOpenSimplex2Noise3D(int32 Seed = FMath::Rand());
+
+	virtual double GetValue(FVector Position) const override;
+
+private:
+	float SampleUnrotated(double XR, double YR, double ZR) const;
+
+	static float Grad(int64 LatticeSeed, uint64 XRVP, uint64 YRVP, uint64 ZRVP, float DX, float DY, float DZ);
+
+private:
+	int64 BaseSeed;
+};
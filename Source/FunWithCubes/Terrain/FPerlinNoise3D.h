@@ -2,13 +2,15 @@
 
 #pragma once
 
-struct FPerlinNoise3D
+#include "NoiseProvider.h"
+
+struct FPerlinNoise3D : public INoiseProvider
 {
 public:
 	FPerlinNoise3D(int32 Seed = FMath::Rand());
 
 	void GenerateNoise(int32 Seed = FMath::Rand());
-	double GetValue(FVector Position) const;
+	virtual double GetValue(FVector Position) const override;
 
 private:
 	static double Fade(double T);
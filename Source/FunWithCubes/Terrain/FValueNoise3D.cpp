@@ -0,0 +1,62 @@
+// Value noise: random values assigned to lattice points, blended with a smoothstep curve.
+
+#include "FValueNoise3D.h"
+
+FValueNoise3D::FValueNoise3D(int32 Seed)
+{
+	FRandomStream Rng(Seed);
+
+	// Shuffled identity permutation, duplicated so that nested lookups never need wrapping.
+	for (int32 i = 0; i < 256; i++)
+	{
+		Permutations[i] = static_cast<uint8>(i);
+	}
+	for (int32 i = 255; i > 0; i--)
+	{
+		Swap(Permutations[i], Permutations[Rng.RandRange(0, i)]);
+	}
+	for (int32 i = 0; i < 256; i++)
+	{
+		Permutations[i + 256] = Permutations[i];
+		LatticeValues[i] = Rng.GetFraction();
+	}
+}
+
+double FValueNoise3D::GetValue(FVector Position) const
+{
+	const float PX = static_cast<float>(Position.X);
+	const float PY = static_cast<float>(Position.Y);
+	const float PZ = static_cast<float>(Position.Z);
+	const float FloorX = FMath::FloorToFloat(PX);
+	const float FloorY = FMath::FloorToFloat(PY);
+	const float FloorZ = FMath::FloorToFloat(PZ);
+	const int32 X = static_cast<int32>(FloorX) & 0xFF;
+	const int32 Y = static_cast<int32>(FloorY) & 0xFF;
+	const int32 Z = static_cast<int32>(FloorZ) & 0xFF;
+	const float FracX = PX - FloorX;
+	const float FracY = PY - FloorY;
+	const float FracZ = PZ - FloorZ;
+	const float U = FracX * FracX * (3.0f - 2.0f * FracX);
+	const float V = FracY * FracY * (3.0f - 2.0f * FracY);
+	const float W = FracZ * FracZ * (3.0f - 2.0f * FracZ);
+	const float Noise = FMath::Lerp(
+		FMath::Lerp(
+			FMath::Lerp(GetLatticeValue(X, Y,     Z), GetLatticeValue(X + 1, Y,     Z), U),
+			FMath::Lerp(GetLatticeValue(X, Y + 1, Z), GetLatticeValue(X + 1, Y + 1, Z), U),
+			V
+		),
+		FMath::Lerp(
+			FMath::Lerp(GetLatticeValue(X, Y,     Z + 1), GetLatticeValue(X + 1, Y,     Z + 1), U),
+			FMath::Lerp(GetLatticeValue(X, Y + 1, Z + 1), GetLatticeValue(X + 1, Y + 1, Z + 1), U),
+			V
+		),
+		W
+	);
+	return Noise;
+}
+
+float FValueNoise3D::GetLatticeValue(int32 X, int32 Y, int32 Z) const
+{
+	// X, Y and Z are at most 256, so every intermediate index stays below 512.
+	return LatticeValues[Permutations[Permutations[Permutations[X] + Y] + Z]];
+}
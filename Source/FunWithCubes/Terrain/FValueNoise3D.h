@@ -0,0 +1,21 @@
+// Value noise: random values assigned to lattice points, blended with a smoothstep curve.
+
+#pragma once
+
+#include "NoiseProvider.h"
+
+// Cheaper but blockier alternative to Perlin noise. All arithmetic is done in single precision.
+struct FValueNoise3D : public INoiseProvider
+{
+public:
+	FValueNoise3D(int32 Seed = FMath::Rand());
+
+	virtual double GetValue(FVector Position) const override;
+
+private:
+	float GetLatticeValue(int32 X, int32 Y, int32 Z) const;
+
+private:
+	uint8 Permutations[512];
+	float LatticeValues[256];
+};
@@ -0,0 +1,44 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#include "NoiseProvider.h"
+
+#include "FOpenSimplex2Noise3D.h"
+#include "FPerlinNoise3D.h"
+#include "FValueNoise3D.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	FSharedNoiseProvider CreateNoiseProvider(ENoiseAlgorithm Algorithm, int32 Seed)
+	{
+		switch (Algorithm)
+		{
+		case ENoiseAlgorithm::OpenSimplex2:
+			return MakeShared<FOpenSimplex2Noise3D, ESPMode::ThreadSafe>(Seed);
+
+		case ENoiseAlgorithm::Value:
+			return MakeShared<FValueNoise3D, ESPMode::ThreadSafe>(Seed);
+
+		case ENoiseAlgorithm::Perlin:
+		default:
+			return MakeShared<FPerlinNoise3D, ESPMode::ThreadSafe>(Seed);
+		}
+	}
+}
+
+FSharedNoiseProvider GetSharedNoiseProvider(ENoiseAlgorithm Algorithm, int32 Seed)
+{
+	// The number of distinct seeds used during a session is tiny (usually one or two per world), so the cache is
+	// never trimmed.
+	static FCriticalSection CacheLock;
+	static TMap<TTuple<ENoiseAlgorithm, int32>, FSharedNoiseProvider> Cache;
+
+	const TTuple<ENoiseAlgorithm, int32> Key(Algorithm, Seed);
+
+	FScopeLock Lock(&CacheLock);
+	if (const FSharedNoiseProvider* CachedProvider = Cache.Find(Key))
+	{
+		return *CachedProvider;
+	}
+	return Cache.Add(Key, CreateNoiseProvider(Algorithm, Seed));
+}
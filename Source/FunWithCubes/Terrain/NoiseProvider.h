@@ -0,0 +1,22 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainGeneratorSettings.h"
+
+// Source of coherent 3D noise used by terrain generation.
+class INoiseProvider
+{
+public:
+	virtual ~INoiseProvider() = default;
+
+	// Returns the noise value at the given position, in range [0, 1].
+	virtual double GetValue(FVector Position) const = 0;
+};
+
+using FSharedNoiseProvider = TSharedRef<const INoiseProvider, ESPMode::ThreadSafe>;
+
+// Returns the noise provider for the given algorithm and seed. Providers are created once per algorithm and seed,
+// and then shared between all chunks and threads. They are immutable, so they can be sampled concurrently.
+FSharedNoiseProvider GetSharedNoiseProvider(ENoiseAlgorithm Algorithm, int32 Seed);
@@ -2,370 +2,391 @@
 
 #include "TerrainChunk.h"
 
-#include "FPerlinNoise3D.h"
 #include "ProceduralMeshComponent.h"
+#include "TerrainGenerationPipeline.h"
+#include "VoxelGrid.h"
 
 // This function assumes vertices are arranged counter-clockwise if the face is looked at from the outside.
 void ATerrainChunk::FMeshSegmentData::AddFace(
-	EVoxelType InVoxel,
-	FVector InNormal,
-	const TMap<EVoxelType, FLinearColor>& Colors,
-	std::initializer_list<FVector> InVertices
+	FColor InColor,
+	FVector3f InNormal,
+	std::initializer_list<FVector3f> InVertices
 ) {
 	check(InVertices.size() == 4);
-	
-	const FLinearColor* MappedColor = Colors.Find(InVoxel);
-	const FLinearColor Color = MappedColor ? *MappedColor : FLinearColor::White;
 
-	VertexColors.Append({ Color, Color, Color, Color });
-	Normals.Append({ InNormal, InNormal, InNormal, InNormal });
-	Vertices.Append(InVertices);
-	Indices.Append({
+	const uint32 VertexCount = Section.GetNumVertices();
+	Section.Colors.Append({ InColor, InColor, InColor, InColor });
+	Section.Normals.Append({ InNormal, InNormal, InNormal, InNormal });
+	Section.Positions.Append(InVertices);
+	Section.Indices.Append({
 		VertexCount + 0, VertexCount + 1, VertexCount + 2,
 		VertexCount + 0, VertexCount + 2, VertexCount + 3,
 	});
-
-	VertexCount += 4;
 }
 
 ATerrainChunk::ATerrainChunk()
 {
 	PrimaryActorTick.bCanEverTick = false;
 
+	ChunkMesh = CreateDefaultSubobject<UChunkMeshComponent>("ChunkMesh");
+	if (ensure(ChunkMesh != nullptr))
+	{
+		RootComponent = ChunkMesh;
+	}
+
+	// Keeps the name it had as the root component, so that blueprint overrides of its settings still apply. It's
+	// only registered when the procedural mesh is selected, so that other chunks don't register an extra primitive.
 	ProceduralMesh = CreateDefaultSubobject<UProceduralMeshComponent>("ProceduralMesh");
 	if (ensure(ProceduralMesh != nullptr))
 	{
+		ProceduralMesh->bAutoRegister = false;
 		ProceduralMesh->bUseAsyncCooking = true;
 		ProceduralMesh->SetSimulatePhysics(false);
-		RootComponent = ProceduralMesh;
+		ProceduralMesh->SetupAttachment(ChunkMesh);
 	}
 }
 
 void ATerrainChunk::GenerateChunk()
 {
-	const TArray<EVoxelType> ChunkData = GenerateVoxels();
-	GenerateMesh(ChunkData);
+	const FIntVector VoxelOrigin(GetActorLocation() / Scale);
+	GenerateChunk(GenerateVoxels(VoxelOrigin, TerrainGeneratorSettings.NoiseSeed));
 }
 
-TArray<EVoxelType> ATerrainChunk::GenerateVoxels() const
+void ATerrainChunk::GenerateChunk(const TArray<EVoxelType>& InVoxels)
 {
-	FRandomStream BedrockRng(TerrainGeneratorSettings.NoiseSeed);
-	FPerlinNoise3D TerrainNoise(TerrainGeneratorSettings.NoiseSeed);
-	FPerlinNoise3D CaveNoise(TerrainGeneratorSettings.NoiseSeed * 13 / 11);
-
-	// Actual number of voxels generated per horizontal dimension is `Resolution + 2`. The reason for the extra
-	// padding is that I want to have access to noise values in neighbouring chunks in order to prevent generating
-	// unnecessary faces on chunk borders. The actual displayed chunk will still have a width of `Resolution`.
-	const int32 PaddedResolution = Resolution + 2;
-	const int32 NumVoxels = FMath::Square(PaddedResolution) * MaxHeight;
-	TArray<EVoxelType> Voxels;
-	Voxels.SetNumZeroed(NumVoxels);
-
-	const int32 NumHeights = FMath::Square(PaddedResolution);
-	TArray<int32> Heights;
-	Heights.SetNumUninitialized(NumHeights);
-
-	FIntVector ChunkLocation(GetActorLocation() / Scale);
-
-	// Account for padding.
-	ChunkLocation.X -= 1;
-	ChunkLocation.Y -= 1;
-	
-	// Generate heights (implementation taken from this GDC talk: https://youtu.be/C9RyEiEzMiU?si=jSK3pGED8GSdpLiy)
-	for (int32 X = 0; X < PaddedResolution; ++X)
+	GenerateMesh(InVoxels);
+}
+
+TArray<EVoxelType> ATerrainChunk::GenerateVoxels(const FIntVector& VoxelOrigin, int32 Seed) const
+{
+	// Actual number of voxels generated per dimension is `Resolution + 2` horizontally and `ChunkHeight + 2`
+	// vertically. The reason for the extra padding is that I want to have access to noise values in neighbouring
+	// chunks in order to prevent generating unnecessary faces on chunk borders. The actual displayed chunk will
+	// still have a size of `Resolution` by `ChunkHeight`.
+	FTerrainGenerationContext Context(TerrainGeneratorSettings, Seed, VoxelOrigin, Resolution, ChunkHeight);
+	FTerrainGenerationPipeline::GetDefault().Execute(Context);
+	return MoveTemp(Context.Voxels);
+}
+
+bool ATerrainChunk::IsAboveTerrain(const FIntVector& VoxelOrigin) const
+{
+	// The bottom padding layer has to be empty as well, otherwise the chunk would need to show the tops of the
+	// blocks below it.
+	const int32 HighestAltitude = FMath::Max(TerrainGeneratorSettings.MaxAltitude, TerrainGeneratorSettings.SeaLevel);
+	return VoxelOrigin.Z - 1 > HighestAltitude;
+}
+
+bool ATerrainChunk::HasVisibleFaces(const TArray<EVoxelType>& InVoxels) const
+{
+	// Data of unexpected size is left for `GenerateMesh` to deal with.
+	if (InVoxels.Num() != GetNumPaddedVoxels(Resolution, ChunkHeight))
+	{
+		return !InVoxels.IsEmpty();
+	}
+
+	bool bHasVisibleFaces = false;
+	DispatchVoxelGrid(InVoxels.GetData(), Resolution, ChunkHeight, [&](auto Grid)
 	{
-		for (int32 Y = 0; Y < PaddedResolution; ++Y)
+		bHasVisibleFaces = HasVisibleFaces(Grid);
+	});
+	return bHasVisibleFaces;
+}
+
+void ATerrainChunk::GenerateMesh(const TArray<EVoxelType>& InVoxels)
+{
+	check(ChunkMesh != nullptr);
+
+	// Meshing accesses neighbours without bounds checks, so the grid has to have exactly the expected size.
+	const int32 NumVoxels = GetNumPaddedVoxels(Resolution, ChunkHeight);
+	const TArray<EVoxelType>* Voxels = &InVoxels;
+	TArray<EVoxelType> ResizedVoxels;
+	if (InVoxels.Num() != NumVoxels)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Voxels array isn't of the desired length %d. Excess voxels will be ignored, and missing ones will be replaced with air."), NumVoxels);
+		ResizedVoxels = InVoxels;
+		ResizedVoxels.SetNumZeroed(NumVoxels);
+		Voxels = &ResizedVoxels;
+	}
+
+	// Resolve colour overrides once, so that the meshing loop only has to index an array.
+	TStaticArray<FColor, NumVoxelTypes> Colors;
+	for (int32 VoxelTypeIndex = 0; VoxelTypeIndex < NumVoxelTypes; ++VoxelTypeIndex)
+	{
+		const EVoxelType VoxelType = static_cast<EVoxelType>(VoxelTypeIndex);
+		const FLinearColor* MappedColor = VoxelColors.Find(VoxelType);
+		Colors[VoxelTypeIndex] = (MappedColor ? *MappedColor : FLinearColor::White).ToFColor(false);
+	}
+
+	TStaticArray<FMeshSegmentData, NumVoxelMeshSections> MeshSegments;
+	DispatchVoxelGrid(Voxels->GetData(), Resolution, ChunkHeight, [&](auto Grid)
+	{
+		GenerateMeshSegments(Grid, Colors, MeshSegments);
+	});
+
+	// Only one of the components holds the mesh at a time, which matters when switching between them in the editor.
+	if (bUseProceduralMesh)
+	{
+		if (ChunkMesh->GetNumSections() > 0)
+		{
+			ChunkMesh->ClearAllSections();
+		}
+		if (!ProceduralMesh->IsRegistered())
 		{
-			const FVector P = FVector(ChunkLocation.X + X, ChunkLocation.Y + Y, 0) * TerrainGeneratorSettings.TerrainScale;
-			const FVector Q = {
-				TerrainNoise.GetValue(P + FVector(0.0, 0.0, 0.0)),
-				TerrainNoise.GetValue(P + FVector(5.2, 1.3, 0.0)),
-				0,
-			};
-			const FVector R = {
-				TerrainNoise.GetValue(P + (4.0 * Q) + FVector(1.7, 9.2, 0.0)),
-				TerrainNoise.GetValue(P + (4.0 * Q) + FVector(8.3, 2.8, 0.0)),
-				0,
-			};
-			const double NoiseValue = TerrainNoise.GetValue(P + (4.0 * R));
-			const int32 Height = TerrainGeneratorSettings.BaseAltitude + (NoiseValue * (TerrainGeneratorSettings.MaxAltitude - TerrainGeneratorSettings.BaseAltitude));
-			Heights[X + (Y * PaddedResolution)] = Height;
+			ProceduralMesh->RegisterComponent();
 		}
 	}
+	else if (ProceduralMesh->IsRegistered())
+	{
+		ProceduralMesh->ClearAllMeshSections();
+		ProceduralMesh->UnregisterComponent();
+	}
 
-	// Generate voxels
-	for (int32 X = 0; X < PaddedResolution; ++X)
+	MeshMemoryBytes = 0;
+	for (int32 SectionIndex = 0; SectionIndex < NumVoxelMeshSections; ++SectionIndex)
 	{
-		for (int32 Y = 0; Y < PaddedResolution; ++Y)
+		FChunkMeshSectionData& SectionData = MeshSegments[SectionIndex].Section;
+		UMaterialInterface* Material = GetSectionMaterial(static_cast<EVoxelMeshSection>(SectionIndex));
+		if (bUseProceduralMesh)
 		{
-			const int32 Height = Heights[X + (Y * PaddedResolution)];
+			MeshMemoryBytes += SectionData.GetNumVertices() * sizeof(FProcMeshVertex) + SectionData.Indices.Num() * sizeof(uint32);
+			SetProceduralMeshSection(SectionIndex, SectionData);
+			ProceduralMesh->SetMaterial(SectionIndex, Material);
+		}
+		else
+		{
+			MeshMemoryBytes += SectionData.GetAllocatedSize();
+			ChunkMesh->SetSection(SectionIndex, MoveTemp(SectionData));
+			ChunkMesh->SetMaterial(SectionIndex, Material);
+		}
+	}
+}
+
+void ATerrainChunk::SetProceduralMeshSection(int32 SectionIndex, const FChunkMeshSectionData& SectionData)
+{
+	// The procedural mesh component only accepts double precision vectors and signed indices.
+	TArray<FVector> Vertices;
+	TArray<FVector> Normals;
+	Vertices.Reserve(SectionData.GetNumVertices());
+	Normals.Reserve(SectionData.GetNumVertices());
+	for (int32 VertexIndex = 0; VertexIndex < SectionData.GetNumVertices(); ++VertexIndex)
+	{
+		Vertices.Add(FVector(SectionData.Positions[VertexIndex]));
+		Normals.Add(FVector(SectionData.Normals[VertexIndex]));
+	}
+
+	TArray<int32> Indices;
+	Indices.Reserve(SectionData.Indices.Num());
+	for (const uint32 Index : SectionData.Indices)
+	{
+		Indices.Add(static_cast<int32>(Index));
+	}
 
-			int32 Z = 0;
+	ProceduralMesh->CreateMeshSection(SectionIndex, Vertices, Indices, Normals, {}, SectionData.Colors, {}, false);
+}
 
-			// Bedrock layer
-			Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Bedrock;
-			++Z;
-			for (; Z < TerrainGeneratorSettings.BedrockThickness; ++Z)
+template <typename GridType>
+void ATerrainChunk::GenerateMeshSegments(
+	const GridType& Grid,
+	const TStaticArray<FColor, NumVoxelTypes>& Colors,
+	TStaticArray<FMeshSegmentData, NumVoxelMeshSections>& OutMeshSegments
+) const {
+	for (int32 VoxelX = 1; VoxelX < Grid.Resolution + 1; VoxelX++)
+	{
+		for (int32 VoxelY = 1; VoxelY < Grid.Resolution + 1; VoxelY++)
+		{
+			int32 VoxelIndex = Grid.GetIndex(VoxelX, VoxelY, 1);
+			for (int32 VoxelZ = 1; VoxelZ < Grid.Height + 1; VoxelZ++, VoxelIndex += Grid.StrideZ)
 			{
-				if (BedrockRng.RandRange(0, 100) < 50)
+				const EVoxelType VoxelType = Grid[VoxelIndex];
+				const FVoxelProperties& Properties = GetVoxelProperties(VoxelType);
+				if (Properties.MeshSection == EVoxelMeshSection::None)
 				{
-					Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Bedrock;
+					continue;
+				}
+
+				FMeshSegmentData& MeshSegmentData = OutMeshSegments[static_cast<int32>(Properties.MeshSection)];
+				const FColor Color = Colors[static_cast<int32>(VoxelType)];
+				const FIntVector VoxelPosition(VoxelX, VoxelY, VoxelZ);
+				
+				if (Properties.bFluid)
+				{
+					AddVoxelFaces<true>(MeshSegmentData, Grid, VoxelIndex, VoxelPosition, Color);
 				}
 				else
 				{
-					Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Stone;
+					AddVoxelFaces<false>(MeshSegmentData, Grid, VoxelIndex, VoxelPosition, Color);
 				}
 			}
+		}
+	}
+}
 
-			// Stone layer
-			for (; Z < Height - TerrainGeneratorSettings.DirtThickness; ++Z)
-			{
-				Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Stone;
-			}
-
-			// Dirt layer
-			for (; Z < Height - 1; ++Z)
-			{
-				Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Dirt;
-			}
+template <typename GridType>
+bool ATerrainChunk::HasVisibleFaces(const GridType& Grid) const
+{
+	for (int32 VoxelX = 1; VoxelX < Grid.Resolution + 1; VoxelX++)
+	{
+		for (int32 VoxelY = 1; VoxelY < Grid.Resolution + 1; VoxelY++)
+		{
+			const bool bEdgeColumn = VoxelX == 1 || VoxelY == 1 || VoxelX == Grid.Resolution || VoxelY == Grid.Resolution;
 
-			// Z == Height
-			if (Z < TerrainGeneratorSettings.SeaLevel)
+			int32 VoxelIndex = Grid.GetIndex(VoxelX, VoxelY, 1);
+			for (int32 VoxelZ = 1; VoxelZ < Grid.Height + 1; VoxelZ++, VoxelIndex += Grid.StrideZ)
 			{
-				if (Z < TerrainGeneratorSettings.SeaLevel - TerrainGeneratorSettings.SandDepth)
+				const FVoxelProperties& Properties = GetVoxelProperties(Grid[VoxelIndex]);
+				if (Properties.MeshSection == EVoxelMeshSection::None)
 				{
-					// Below maximum sand depth: dirt
-					Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Dirt;
-					++Z;
+					continue;
 				}
-				else if (
-					Z > TerrainGeneratorSettings.SeaLevel - TerrainGeneratorSettings.SandDepth
-					&& Z <= TerrainGeneratorSettings.SeaLevel
-				) {
-					// Between sea level and maximum sand depth: sand
-					Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Sand;
-					++Z;
+
+				const bool bEdgeVoxel = bEdgeColumn || VoxelZ == 1 || VoxelZ == Grid.Height;
+				if (bShowChunkEdgeFaces && bEdgeVoxel)
+				{
+					return true;
 				}
 
-				// Water
-				for (; Z <= TerrainGeneratorSettings.SeaLevel; ++Z)
+				const bool bVisible = Properties.bFluid
+					? HasVisibleNeighbour<true>(Grid, VoxelIndex)
+					: HasVisibleNeighbour<false>(Grid, VoxelIndex);
+				if (bVisible)
 				{
-					Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Water;
+					return true;
 				}
 			}
-			else if (Z == TerrainGeneratorSettings.SeaLevel)
-			{
-				// Coastal beaches
-				Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Sand;
-			}
-			else
-			{
-				// Fields
-				Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Grass;
-			}
 		}
 	}
+	return false;
+}
 
-	// Carve out caves
-	for (int32 X = 0; X < PaddedResolution; ++X)
+template <bool bFluid, typename GridType>
+bool ATerrainChunk::HasVisibleNeighbour(const GridType& Grid, int32 VoxelIndex)
+{
+	return IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex + Grid.StrideX])
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex - Grid.StrideX])
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex + Grid.StrideY])
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex - Grid.StrideY])
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex + Grid.StrideZ])
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex - Grid.StrideZ]);
+}
+
+template <bool bFluid, typename GridType>
+void ATerrainChunk::AddVoxelFaces(
+	FMeshSegmentData& MeshSegmentData,
+	const GridType& Grid,
+	int32 VoxelIndex,
+	FIntVector VoxelPosition,
+	FColor Color
+) const {
+	// Vertex offsets
+	double VertTopOffset = 0.0;
+	if constexpr (bFluid)
 	{
-		for (int32 Y = 0; Y < PaddedResolution; ++Y)
+		if (!IsVoxelFluid(Grid[VoxelIndex + Grid.StrideZ]))
 		{
-			for (int32 Z = 0; Z < MaxHeight; ++Z)
-			{
-				const double Noise = CaveNoise.GetValue(
-					(FVector(ChunkLocation) + FVector(X, Y, Z)) * TerrainGeneratorSettings.CaveScale);
-
-				// Avoid removing bedrock, water, and solid blocks neighbouring with water (except from above).
-				if (
-					Noise >= TerrainGeneratorSettings.CaveThreshold
-					&& GetVoxelOrAir(Voxels, X,     Y,     Z    ) != EVoxelType::Bedrock
-					&& GetVoxelOrAir(Voxels, X,     Y,     Z    ) != EVoxelType::Water
-					&& GetVoxelOrAir(Voxels, X,     Y,     Z + 1) != EVoxelType::Water
-					&& GetVoxelOrAir(Voxels, X,     Y + 1, Z    ) != EVoxelType::Water
-					&& GetVoxelOrAir(Voxels, X,     Y - 1, Z    ) != EVoxelType::Water
-					&& GetVoxelOrAir(Voxels, X - 1, Y,     Z    ) != EVoxelType::Water
-					&& GetVoxelOrAir(Voxels, X + 1, Y,     Z    ) != EVoxelType::Water
-				) {
-					Voxels[ChunkCoordsToVoxelIndex(X, Y, Z)] = EVoxelType::Air;
-				}
-			}
+			VertTopOffset = 0.1;
 		}
 	}
 	
-	return Voxels;
-}
-
-void ATerrainChunk::GenerateMesh(const TArray<EVoxelType>& InVoxels)
-{
-	check(ProceduralMesh != nullptr);
+	// Positions are relative to the chunk, so single precision is enough.
+	const float VertFront  = static_cast<float>(Scale * (VoxelPosition.X - 0));
+	const float VertBack   = static_cast<float>(Scale * (VoxelPosition.X - 1));
+	const float VertRight  = static_cast<float>(Scale * (VoxelPosition.Y - 0));
+	const float VertLeft   = static_cast<float>(Scale * (VoxelPosition.Y - 1));
+	const float VertTop    = static_cast<float>(Scale * ((VoxelPosition.Z - 0) - VertTopOffset));
+	const float VertBottom = static_cast<float>(Scale * (VoxelPosition.Z - 1));
 	
-	const int32 NumVoxels = FMath::Square(Resolution + 2) * MaxHeight;
-	if (InVoxels.Num() != NumVoxels)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Voxels array isn't of the desired length %d. Excess voxels will be ignored, and missing ones will be replaced with air."), NumVoxels);
+	// Generate faces only where the neighbouring block doesn't hide them.
+				
+	// Front neighbour
+	if (
+		(VoxelPosition.X == Grid.Resolution && bShowChunkEdgeFaces)
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex + Grid.StrideX])
+	) {
+		MeshSegmentData.AddFace(Color, FVector3f::ForwardVector, {
+			FVector3f(VertFront, VertRight, VertBottom),
+			FVector3f(VertFront, VertLeft,  VertBottom),
+			FVector3f(VertFront, VertLeft,  VertTop),
+			FVector3f(VertFront, VertRight, VertTop),
+		});
 	}
-
-	FMeshSegmentData TerrainMeshData;
-	FMeshSegmentData WaterMeshData;
-
-	const auto AddFacesForBlock = [this, &InVoxels](
-		FMeshSegmentData& MeshSegmentData,
-		EVoxelType VoxelType,
-		FIntVector VoxelPosition,
-		const auto& NeighbourCondition
+	
+	// Back neighbour
+	if (
+		(VoxelPosition.X == 1 && bShowChunkEdgeFaces)
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex - Grid.StrideX])
 	) {
-		// Vertex offsets
-		double VertTopOffset = 0.0;
-		if (VoxelType == EVoxelType::Water)
-		{
-			if (GetVoxelOrAir(InVoxels, VoxelPosition.X, VoxelPosition.Y, VoxelPosition.Z + 1) != EVoxelType::Water)
-			{
-				VertTopOffset = 0.1;
-			}
-		}
-		
-		const double VertFront  = Scale * (VoxelPosition.X - 0);
-		const double VertBack   = Scale * (VoxelPosition.X - 1);
-		const double VertRight  = Scale * (VoxelPosition.Y - 0);
-		const double VertLeft   = Scale * (VoxelPosition.Y - 1);
-		const double VertTop    = Scale * ((VoxelPosition.Z - 0) - VertTopOffset);
-		const double VertBottom = Scale * (VoxelPosition.Z - 1);
-		
-		// Generate faces only where the neighbouring block isn't solid.
-					
-		// Front neighbour
-		if (
-			(VoxelPosition.X == Resolution && bShowChunkEdgeFaces)
-			|| NeighbourCondition(GetVoxelOrAir(InVoxels, VoxelPosition.X + 1, VoxelPosition.Y, VoxelPosition.Z))
-		) {
-			MeshSegmentData.AddFace(VoxelType, FVector::ForwardVector, VoxelColors, {
-				FVector(VertFront, VertRight, VertBottom),
-				FVector(VertFront, VertLeft,  VertBottom),
-				FVector(VertFront, VertLeft,  VertTop),
-				FVector(VertFront, VertRight, VertTop),
-			});
-		}
-		
-		// Back neighbour
-		if (
-			(VoxelPosition.X == 1 && bShowChunkEdgeFaces)
-			|| NeighbourCondition(GetVoxelOrAir(InVoxels, VoxelPosition.X - 1, VoxelPosition.Y, VoxelPosition.Z))
-		) {
-			MeshSegmentData.AddFace(VoxelType, FVector::BackwardVector, VoxelColors, {
-				FVector(VertBack, VertRight, VertBottom),
-				FVector(VertBack, VertRight, VertTop),
-				FVector(VertBack, VertLeft,  VertTop),
-				FVector(VertBack, VertLeft,  VertBottom),
-			});
-		}
-		
-		// Right neighbour
-		if (
-			(VoxelPosition.Y == Resolution && bShowChunkEdgeFaces)
-			|| NeighbourCondition(GetVoxelOrAir(InVoxels, VoxelPosition.X, VoxelPosition.Y + 1, VoxelPosition.Z))
-		) {
-			MeshSegmentData.AddFace(VoxelType, FVector::RightVector, VoxelColors, {
-				FVector(VertFront, VertRight, VertBottom),
-				FVector(VertFront, VertRight, VertTop),
-				FVector(VertBack,  VertRight, VertTop),
-				FVector(VertBack,  VertRight, VertBottom),
-			});
-		}
-		
-		// Left neighbour
-		if (
-			(VoxelPosition.Y == 1 && bShowChunkEdgeFaces)
-			|| NeighbourCondition(GetVoxelOrAir(InVoxels, VoxelPosition.X, VoxelPosition.Y - 1, VoxelPosition.Z))
-		) {
-			MeshSegmentData.AddFace(VoxelType, FVector::LeftVector, VoxelColors, {
-				FVector(VertBack,  VertLeft, VertTop),
-				FVector(VertFront, VertLeft, VertTop),
-				FVector(VertFront, VertLeft, VertBottom),
-				FVector(VertBack,  VertLeft, VertBottom),
-			});
-		}
-		
-		// Top neighbour
-		if (
-			(VoxelPosition.Z == MaxHeight - 1 && bShowChunkEdgeFaces)
-			|| NeighbourCondition(GetVoxelOrAir(InVoxels, VoxelPosition.X, VoxelPosition.Y, VoxelPosition.Z + 1))
-		) {
-			MeshSegmentData.AddFace(VoxelType, FVector::UpVector, VoxelColors, {
-				FVector(VertFront, VertRight, VertTop),
-				FVector(VertFront, VertLeft,  VertTop),
-				FVector(VertBack,  VertLeft,  VertTop),
-				FVector(VertBack,  VertRight, VertTop),
-			});
-		}
+		MeshSegmentData.AddFace(Color, FVector3f::BackwardVector, {
+			FVector3f(VertBack, VertRight, VertBottom),
+			FVector3f(VertBack, VertRight, VertTop),
+			FVector3f(VertBack, VertLeft,  VertTop),
+			FVector3f(VertBack, VertLeft,  VertBottom),
+		});
+	}
+	
+	// Right neighbour
+	if (
+		(VoxelPosition.Y == Grid.Resolution && bShowChunkEdgeFaces)
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex + Grid.StrideY])
+	) {
+		MeshSegmentData.AddFace(Color, FVector3f::RightVector, {
+			FVector3f(VertFront, VertRight, VertBottom),
+			FVector3f(VertFront, VertRight, VertTop),
+			FVector3f(VertBack,  VertRight, VertTop),
+			FVector3f(VertBack,  VertRight, VertBottom),
+		});
+	}
+	
+	// Left neighbour
+	if (
+		(VoxelPosition.Y == 1 && bShowChunkEdgeFaces)
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex - Grid.StrideY])
+	) {
+		MeshSegmentData.AddFace(Color, FVector3f::LeftVector, {
+			FVector3f(VertBack,  VertLeft, VertTop),
+			FVector3f(VertFront, VertLeft, VertTop),
+			FVector3f(VertFront, VertLeft, VertBottom),
+			FVector3f(VertBack,  VertLeft, VertBottom),
+		});
+	}
+	
+	// Top neighbour
+	if (
+		(VoxelPosition.Z == Grid.Height && bShowChunkEdgeFaces)
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex + Grid.StrideZ])
+	) {
+		MeshSegmentData.AddFace(Color, FVector3f::UpVector, {
+			FVector3f(VertFront, VertRight, VertTop),
+			FVector3f(VertFront, VertLeft,  VertTop),
+			FVector3f(VertBack,  VertLeft,  VertTop),
+			FVector3f(VertBack,  VertRight, VertTop),
+		});
+	}
 
-		// Bottom neighbour
-		if (
-			(VoxelPosition.Z == 0 && bShowChunkEdgeFaces)
-			|| NeighbourCondition(GetVoxelOrAir(InVoxels, VoxelPosition.X, VoxelPosition.Y, VoxelPosition.Z - 1))
-		) {
-			MeshSegmentData.AddFace(VoxelType, FVector::DownVector, VoxelColors, {
-				FVector(VertBack,  VertLeft,  VertBottom),
-				FVector(VertFront, VertLeft,  VertBottom),
-				FVector(VertFront, VertRight, VertBottom),
-				FVector(VertBack,  VertRight, VertBottom),
-			});
-		}
-	};
+	// Bottom neighbour
+	if (
+		(VoxelPosition.Z == 1 && bShowChunkEdgeFaces)
+		|| IsVoxelFaceVisible<bFluid>(Grid[VoxelIndex - Grid.StrideZ])
+	) {
+		MeshSegmentData.AddFace(Color, FVector3f::DownVector, {
+			FVector3f(VertBack,  VertLeft,  VertBottom),
+			FVector3f(VertFront, VertLeft,  VertBottom),
+			FVector3f(VertFront, VertRight, VertBottom),
+			FVector3f(VertBack,  VertRight, VertBottom),
+		});
+	}
+}
 
-	for (int32 VoxelX = 1; VoxelX < Resolution + 1; VoxelX++)
+UMaterialInterface* ATerrainChunk::GetSectionMaterial(EVoxelMeshSection Section) const
+{
+	switch (Section)
 	{
-		for (int32 VoxelY = 1; VoxelY < Resolution + 1; VoxelY++)
-		{
-			for (int32 VoxelZ = 0; VoxelZ < MaxHeight; VoxelZ++)
-			{
-				const EVoxelType VoxelType = GetVoxelOrAir(InVoxels, VoxelX, VoxelY, VoxelZ);
-				
-				if (IsVoxelSolid(VoxelType))
-				{
-					AddFacesForBlock(
-						TerrainMeshData,
-						VoxelType,
-						FIntVector(VoxelX, VoxelY, VoxelZ),
-						[](EVoxelType V) { return !IsVoxelSolid(V); }
-					);
-				}
-				else if (VoxelType == EVoxelType::Water)
-				{
-					AddFacesForBlock(
-						WaterMeshData,
-						VoxelType,
-						FIntVector(VoxelX, VoxelY, VoxelZ),
-						[](EVoxelType V) { return V == EVoxelType::Air; }
-					);
-				}
-			}
-		}
+	case EVoxelMeshSection::Terrain:
+		return TerrainMaterial;
+	case EVoxelMeshSection::Water:
+		return WaterMaterial;
+	default:
+		return nullptr;
 	}
-	
-	ProceduralMesh->CreateMeshSection_LinearColor(
-		0,
-		TerrainMeshData.Vertices,
-		TerrainMeshData.Indices,
-		TerrainMeshData.Normals,
-		{},
-		TerrainMeshData.VertexColors,
-		{},
-		false
-	);
-	ProceduralMesh->CreateMeshSection_LinearColor(
-		1,
-		WaterMeshData.Vertices,
-		WaterMeshData.Indices,
-		WaterMeshData.Normals,
-		{},
-		WaterMeshData.VertexColors,
-		{},
-		false
-	);
-
-	ProceduralMesh->SetMaterial(0, TerrainMaterial);
-	ProceduralMesh->SetMaterial(1, WaterMaterial);
 }
 
 void ATerrainChunk::RandomSeed()
@@ -383,18 +404,3 @@ void ATerrainChunk::OnConstruction(const FTransform& Transform)
 	
 	Super::OnConstruction(Transform);
 }
-
-int32 ATerrainChunk::ChunkCoordsToVoxelIndex(int32 X, int32 Y, int32 Z) const
-{
-	return Z + (Y * MaxHeight) + (X * MaxHeight * (Resolution + 2));
-}
-
-EVoxelType ATerrainChunk::GetVoxelOrAir(const TArray<EVoxelType>& InVoxels, int32 X, int32 Y, int32 Z) const
-{
-	const int32 VoxelIndex = ChunkCoordsToVoxelIndex(X, Y, Z);
-	if (!InVoxels.IsValidIndex(VoxelIndex))
-	{
-		return EVoxelType::Air;
-	}
-	return InVoxels[VoxelIndex];
-}
@@ -3,6 +3,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ChunkMeshComponent.h"
+#include "Containers/StaticArray.h"
 #include "GameFramework/Actor.h"
 #include "VoxelType.h"
 #include "TerrainGeneratorSettings.h"
@@ -17,17 +19,13 @@ class FUNWITHCUBES_API ATerrainChunk : public AActor
 protected:
 	struct FMeshSegmentData
 	{
-		TArray<FVector> Vertices;
-		TArray<FVector> Normals;
-		TArray<int32> Indices;
-		TArray<FLinearColor> VertexColors;
-		int32 VertexCount = 0;
+		// Built in the renderer's vertex format, so that it can be moved into the chunk mesh component as is.
+		FChunkMeshSectionData Section;
 
 		void AddFace(
-			EVoxelType InVoxel,
-			FVector InNormal,
-			const TMap<EVoxelType, FLinearColor>& Colors,
-			std::initializer_list<FVector> InVertices
+			FColor InColor,
+			FVector3f InNormal,
+			std::initializer_list<FVector3f> InVertices
 		);
 	};
 	
@@ -35,13 +33,30 @@ public:
 	ATerrainChunk();
 
 	void GenerateChunk();
+	void GenerateChunk(const TArray<EVoxelType>& InVoxels);
+
+	// Generates voxel data for a chunk whose first (non-padding) voxel lies at `VoxelOrigin` in world voxel
+	// coordinates. This doesn't depend on the state of the actor, so it can be called on the class default object
+	// to find out whether a chunk is worth spawning at all.
+	TArray<EVoxelType> GenerateVoxels(const FIntVector& VoxelOrigin, int32 Seed) const;
+
+	// Whether a chunk starting at `VoxelOrigin` lies entirely above both the terrain surface and the sea level,
+	// and hence would only contain air.
+	bool IsAboveTerrain(const FIntVector& VoxelOrigin) const;
+
+	// Whether meshing the given voxel data would produce any faces. Stops at the first visible face, so that chunks
+	// which have nothing to mesh (e.g. buried underground, or entirely under water) don't need to be spawned.
+	bool HasVisibleFaces(const TArray<EVoxelType>& InVoxels) const;
 
 	void SetRngSeed(int32 Seed) { TerrainGeneratorSettings.NoiseSeed = Seed; }
 	
 	int32 GetResolution() const { return Resolution; }
-	int32 GetMaxHeight() const { return MaxHeight; }
+	int32 GetChunkHeight() const { return ChunkHeight; }
 	double GetScale() const { return Scale; }
 
+	// Approximate size of the mesh data held by the chunk's mesh component.
+	int64 GetMeshMemoryBytes() const { return MeshMemoryBytes; }
+
 protected: // Details buttons
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Terrain Chunk")
 	void RandomSeed();
@@ -50,13 +65,42 @@ protected: // Function overrides
 	virtual void OnConstruction(const FTransform& Transform) override;
 	
 protected: // Helper functions
-	TArray<EVoxelType> GenerateVoxels() const;
 	void GenerateMesh(const TArray<EVoxelType>& InVoxels);
+	void SetProceduralMeshSection(int32 SectionIndex, const FChunkMeshSectionData& SectionData);
+
+	// Generates faces of all non-padding voxels in the grid. Instantiated for every grid specialisation, so that
+	// neighbours are accessed with constant strides and no bounds checks.
+	template <typename GridType>
+	void GenerateMeshSegments(
+		const GridType& Grid,
+		const TStaticArray<FColor, NumVoxelTypes>& Colors,
+		TStaticArray<FMeshSegmentData, NumVoxelMeshSections>& OutMeshSegments
+	) const;
+
+	template <typename GridType>
+	bool HasVisibleFaces(const GridType& Grid) const;
+
+	// Whether any of the voxel's neighbours leaves its face visible.
+	template <bool bFluid, typename GridType>
+	static bool HasVisibleNeighbour(const GridType& Grid, int32 VoxelIndex);
 
-	int32 ChunkCoordsToVoxelIndex(int32 X, int32 Y, int32 Z) const;
-	EVoxelType GetVoxelOrAir(const TArray<EVoxelType>& InVoxels, int32 X, int32 Y, int32 Z) const;
+	// Adds faces of a single voxel to the mesh segment. Specialised on whether the voxel is a fluid, so that the
+	// face visibility checks reduce to a single property table lookup per neighbour.
+	template <bool bFluid, typename GridType>
+	void AddVoxelFaces(
+		FMeshSegmentData& MeshSegmentData,
+		const GridType& Grid,
+		int32 VoxelIndex,
+		FIntVector VoxelPosition,
+		FColor Color
+	) const;
+
+	UMaterialInterface* GetSectionMaterial(EVoxelMeshSection Section) const;
 	
 protected: // Data
+	UPROPERTY(EditDefaultsOnly)
+	UChunkMeshComponent* ChunkMesh = nullptr;
+
 	UPROPERTY(EditDefaultsOnly)
 	class UProceduralMeshComponent* ProceduralMesh = nullptr;
 
@@ -65,7 +109,7 @@ protected: // Data
 	UPROPERTY(EditDefaultsOnly)
 	UMaterialInterface* WaterMaterial = nullptr;
 	
-	// Colours associated with each block type.
+	// Colours associated with each block type. Block types missing from this map are white.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TMap<EVoxelType, FLinearColor> VoxelColors;
 
@@ -77,9 +121,10 @@ protected: // Data
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	double Scale = 1.0;
 
-	// Height limit of the chunk.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 MaxHeight = 64;
+	// Number of blocks in the chunk along the Z axis. Chunks are stacked vertically, so this doesn't limit the
+	// height of the world.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1, UIMin = 1))
+	int32 ChunkHeight = 32;
 
 	// Whether chunk edges should appear in the chunk mesh.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
@@ -88,7 +133,15 @@ protected: // Data
 	// Whether chunk edges should appear in the chunk mesh.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool bGenerateOnConstruction = false;
+
+	// Whether the mesh should be built with the procedural mesh component rather than the chunk mesh component.
+	// It's slower and takes more memory, as the mesh is converted and copied a few times along the way.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseProceduralMesh = false;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FTerrainGeneratorSettings TerrainGeneratorSettings;
+
+	UPROPERTY(Transient)
+	int64 MeshMemoryBytes = 0;
 };
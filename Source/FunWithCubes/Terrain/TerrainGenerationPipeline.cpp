@@ -0,0 +1,119 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#include "TerrainGenerationPipeline.h"
+
+#include "HAL/IConsoleManager.h"
+#include "TerrainGenerationStages.h"
+
+FTerrainGenerationContext::FTerrainGenerationContext(
+	const FTerrainGeneratorSettings& InSettings,
+	int32 InSeed,
+	const FIntVector& InVoxelOrigin,
+	int32 InResolution,
+	int32 InChunkHeight
+)
+	: Settings(InSettings)
+	, Seed(InSeed)
+	, ChunkLocation(InVoxelOrigin - FIntVector(1, 1, 1))
+	, Resolution(InResolution)
+	, ChunkHeight(InChunkHeight)
+	, PaddedResolution(InResolution + 2)
+	, PaddedHeight(InChunkHeight + 2)
+{
+	Voxels.SetNumZeroed(GetNumPaddedVoxels(Resolution, ChunkHeight));
+}
+
+bool FTerrainGenerationPipeline::RegisterStage(TUniquePtr<ITerrainGenerationStage> Stage)
+{
+	if (!ensure(Stage.IsValid()))
+	{
+		return false;
+	}
+
+	if (!EnumHasAllFlags(AvailableData, Stage->GetInputs()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Terrain generation stage %s depends on data which isn't produced by any earlier stage."), *Stage->GetName().ToString());
+		return false;
+	}
+
+	AvailableData |= Stage->GetOutputs();
+
+	TUniquePtr<FRegisteredStage> RegisteredStage = MakeUnique<FRegisteredStage>();
+	RegisteredStage->Stage = MoveTemp(Stage);
+	Stages.Add(MoveTemp(RegisteredStage));
+	return true;
+}
+
+void FTerrainGenerationPipeline::Execute(FTerrainGenerationContext& Context) const
+{
+	for (const TUniquePtr<FRegisteredStage>& RegisteredStage : Stages)
+	{
+		if (!RegisteredStage->Stage->AffectsChunk(Context))
+		{
+			++RegisteredStage->NumSkips;
+			continue;
+		}
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		RegisteredStage->Stage->Execute(Context);
+		RegisteredStage->Cycles += FPlatformTime::Cycles64() - StartCycles;
+		++RegisteredStage->NumExecutions;
+	}
+}
+
+TArray<FTerrainGenerationStageStats> FTerrainGenerationPipeline::GetStats() const
+{
+	TArray<FTerrainGenerationStageStats> Stats;
+	Stats.Reserve(Stages.Num());
+	for (const TUniquePtr<FRegisteredStage>& RegisteredStage : Stages)
+	{
+		FTerrainGenerationStageStats& StageStats = Stats.AddDefaulted_GetRef();
+		StageStats.Name = RegisteredStage->Stage->GetName();
+		StageStats.TotalSeconds = FPlatformTime::ToSeconds64(RegisteredStage->Cycles);
+		StageStats.NumExecutions = RegisteredStage->NumExecutions;
+		StageStats.NumSkips = RegisteredStage->NumSkips;
+	}
+	return Stats;
+}
+
+void FTerrainGenerationPipeline::ResetStats()
+{
+	for (const TUniquePtr<FRegisteredStage>& RegisteredStage : Stages)
+	{
+		RegisteredStage->Cycles = 0;
+		RegisteredStage->NumExecutions = 0;
+		RegisteredStage->NumSkips = 0;
+	}
+}
+
+FTerrainGenerationPipeline& FTerrainGenerationPipeline::GetDefault()
+{
+	static FTerrainGenerationPipeline Pipeline = []
+	{
+		FTerrainGenerationPipeline DefaultPipeline;
+		DefaultPipeline.RegisterStage(MakeUnique<FHeightMapStage>());
+		DefaultPipeline.RegisterStage(MakeUnique<FStrataStage>());
+		DefaultPipeline.RegisterStage(MakeUnique<FFluidStage>());
+		DefaultPipeline.RegisterStage(MakeUnique<FCaveCarverStage>());
+		return DefaultPipeline;
+	}();
+	return Pipeline;
+}
+
+static FAutoConsoleCommand LogTerrainGenerationStatsCommand(
+	TEXT("Terrain.LogGenerationStats"),
+	TEXT("Logs the time spent in each terrain generation stage since the last reset, then resets it."),
+	FConsoleCommandDelegate::CreateLambda([]
+	{
+		FTerrainGenerationPipeline& Pipeline = FTerrainGenerationPipeline::GetDefault();
+		for (const FTerrainGenerationStageStats& Stats : Pipeline.GetStats())
+		{
+			const double AverageMilliseconds = Stats.NumExecutions > 0
+				? 1000.0 * Stats.TotalSeconds / Stats.NumExecutions
+				: 0.0;
+			UE_LOG(LogTemp, Display, TEXT("%s: %.2f ms total, %.3f ms average, %lld runs, %lld skipped chunks"),
+				*Stats.Name.ToString(), 1000.0 * Stats.TotalSeconds, AverageMilliseconds, Stats.NumExecutions, Stats.NumSkips);
+		}
+		Pipeline.ResetStats();
+	})
+);
@@ -0,0 +1,132 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainGeneratorSettings.h"
+#include "VoxelGrid.h"
+#include "VoxelType.h"
+
+#include <atomic>
+
+// Kinds of data produced and consumed by terrain generation stages.
+enum class ETerrainGenerationData : uint8
+{
+	None    = 0,
+	Heights = 1 << 0, // Surface altitude of every column.
+	Strata  = 1 << 1, // Bedrock, stone, dirt, and the surface blocks.
+	Fluids  = 1 << 2, // Seas and lakes.
+	Carving = 1 << 3, // Caves and other holes removed from the terrain.
+};
+ENUM_CLASS_FLAGS(ETerrainGenerationData);
+
+// Everything the stages know about the chunk being generated.
+struct FTerrainGenerationContext
+{
+	FTerrainGenerationContext(
+		const FTerrainGeneratorSettings& InSettings,
+		int32 InSeed,
+		const FIntVector& InVoxelOrigin,
+		int32 InResolution,
+		int32 InChunkHeight
+	);
+
+	const FTerrainGeneratorSettings& Settings;
+	const int32 Seed;
+
+	// World voxel coordinates of the first padding voxel of the chunk.
+	const FIntVector ChunkLocation;
+
+	// Size of the chunk without and with one voxel of padding on every side.
+	const int32 Resolution;
+	const int32 ChunkHeight;
+	const int32 PaddedResolution;
+	const int32 PaddedHeight;
+
+	// Output voxels, laid out as described by `TVoxelGrid`. Initially filled with air.
+	TArray<EVoxelType> Voxels;
+
+	// Surface altitude of every padded column, and the lowest and highest of them.
+	TArray<int32> Heights;
+	int32 MinSurfaceAltitude = MAX_int32;
+	int32 MaxSurfaceAltitude = MIN_int32;
+
+	int32 GetColumnIndex(int32 X, int32 Y) const
+	{
+		return X + (Y * PaddedResolution);
+	}
+
+	// Converts the altitude range [FromAltitude, ToAltitude) into a range of chunk-local Z coordinates.
+	// Returns false if the range doesn't overlap with the chunk, so that the column can be skipped.
+	bool ClampAltitudeRange(int32 FromAltitude, int32 ToAltitude, int32& OutMinZ, int32& OutMaxZ) const
+	{
+		OutMinZ = FMath::Max(FromAltitude, ChunkLocation.Z) - ChunkLocation.Z;
+		OutMaxZ = FMath::Min(ToAltitude, ChunkLocation.Z + PaddedHeight) - ChunkLocation.Z;
+		return OutMinZ < OutMaxZ;
+	}
+
+	// Calls `Functor` with a grid over the output voxels specialised for the chunk dimensions.
+	template <typename FunctorType>
+	void DispatchGrid(FunctorType&& Functor)
+	{
+		DispatchVoxelGrid(Voxels.GetData(), Resolution, ChunkHeight, Forward<FunctorType>(Functor));
+	}
+};
+
+// A single step of terrain generation, such as shaping the height map or carving caves.
+class ITerrainGenerationStage
+{
+public:
+	virtual ~ITerrainGenerationStage() = default;
+
+	virtual FName GetName() const = 0;
+
+	// Data which has to be produced by earlier stages before this one can run.
+	virtual ETerrainGenerationData GetInputs() const = 0;
+	virtual ETerrainGenerationData GetOutputs() const = 0;
+
+	// Whether the stage can change anything in the chunk. Stages should return false when the chunk lies entirely
+	// outside of the altitudes they work on, so that they don't have to sweep it at all. Within a chunk, stages are
+	// expected to clamp each column to the altitudes they affect.
+	virtual bool AffectsChunk(const FTerrainGenerationContext& Context) const { return true; }
+
+	virtual void Execute(FTerrainGenerationContext& Context) const = 0;
+};
+
+struct FTerrainGenerationStageStats
+{
+	FName Name;
+	double TotalSeconds = 0.0;
+	int64 NumExecutions = 0;
+	int64 NumSkips = 0;
+};
+
+// Ordered list of stages run for every generated chunk. Safe to execute from multiple threads at once once all
+// stages have been registered.
+class FTerrainGenerationPipeline
+{
+public:
+	// Appends a stage to the pipeline. Fails if the stage depends on data that none of the earlier stages produce.
+	bool RegisterStage(TUniquePtr<ITerrainGenerationStage> Stage);
+
+	void Execute(FTerrainGenerationContext& Context) const;
+
+	// Time spent in each stage since the last reset, in the order of execution.
+	TArray<FTerrainGenerationStageStats> GetStats() const;
+	void ResetStats();
+
+	// Pipeline containing the built-in height map, strata, fluid, and cave stages.
+	static FTerrainGenerationPipeline& GetDefault();
+
+private:
+	struct FRegisteredStage
+	{
+		TUniquePtr<ITerrainGenerationStage> Stage;
+		mutable std::atomic<uint64> Cycles { 0 };
+		mutable std::atomic<int64> NumExecutions { 0 };
+		mutable std::atomic<int64> NumSkips { 0 };
+	};
+
+	TArray<TUniquePtr<FRegisteredStage>> Stages;
+	ETerrainGenerationData AvailableData = ETerrainGenerationData::None;
+};
@@ -0,0 +1,222 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#include "TerrainGenerationStages.h"
+
+#include "NoiseProvider.h"
+
+void FHeightMapStage::Execute(FTerrainGenerationContext& Context) const
+{
+	const FTerrainGeneratorSettings& Settings = Context.Settings;
+	const FSharedNoiseProvider TerrainNoise = GetSharedNoiseProvider(Settings.NoiseAlgorithm, Context.Seed);
+
+	Context.Heights.SetNumUninitialized(FMath::Square(Context.PaddedResolution));
+
+	// Implementation taken from this GDC talk: https://youtu.be/C9RyEiEzMiU?si=jSK3pGED8GSdpLiy
+	for (int32 X = 0; X < Context.PaddedResolution; ++X)
+	{
+		for (int32 Y = 0; Y < Context.PaddedResolution; ++Y)
+		{
+			const FVector P = FVector(Context.ChunkLocation.X + X, Context.ChunkLocation.Y + Y, 0) * Settings.TerrainScale;
+			const FVector Q = {
+				TerrainNoise->GetValue(P + FVector(0.0, 0.0, 0.0)),
+				TerrainNoise->GetValue(P + FVector(5.2, 1.3, 0.0)),
+				0,
+			};
+			const FVector R = {
+				TerrainNoise->GetValue(P + (4.0 * Q) + FVector(1.7, 9.2, 0.0)),
+				TerrainNoise->GetValue(P + (4.0 * Q) + FVector(8.3, 2.8, 0.0)),
+				0,
+			};
+			const double NoiseValue = TerrainNoise->GetValue(P + (4.0 * R));
+			const int32 Height = Settings.BaseAltitude + (NoiseValue * (Settings.MaxAltitude - Settings.BaseAltitude));
+
+			// Heights are stored as the altitude of the topmost block, which can't be lower than the bedrock layer.
+			const int32 Surface = FMath::Max(Height - 1, Settings.BedrockThickness);
+			Context.Heights[Context.GetColumnIndex(X, Y)] = Surface;
+			Context.MinSurfaceAltitude = FMath::Min(Context.MinSurfaceAltitude, Surface);
+			Context.MaxSurfaceAltitude = FMath::Max(Context.MaxSurfaceAltitude, Surface);
+		}
+	}
+}
+
+bool FStrataStage::AffectsChunk(const FTerrainGenerationContext& Context) const
+{
+	return Context.ChunkLocation.Z <= Context.MaxSurfaceAltitude;
+}
+
+void FStrataStage::Execute(FTerrainGenerationContext& Context) const
+{
+	Context.DispatchGrid([&Context](auto Grid)
+	{
+		const FTerrainGeneratorSettings& Settings = Context.Settings;
+		FRandomStream BedrockRng(Context.Seed);
+
+		for (int32 X = 0; X < Grid.PaddedResolution; ++X)
+		{
+			for (int32 Y = 0; Y < Grid.PaddedResolution; ++Y)
+			{
+				const int32 Surface = Context.Heights[Context.GetColumnIndex(X, Y)];
+				const int32 ColumnIndex = Grid.GetIndex(X, Y, 0);
+
+				const auto FillLayer = [&](int32 FromAltitude, int32 ToAltitude, EVoxelType VoxelType)
+				{
+					int32 MinZ, MaxZ;
+					if (Context.ClampAltitudeRange(FromAltitude, ToAltitude, MinZ, MaxZ))
+					{
+						for (int32 Z = MinZ; Z < MaxZ; ++Z)
+						{
+							Grid[ColumnIndex + Z] = VoxelType;
+						}
+					}
+				};
+
+				// Anything at or below the bottom of the world is bedrock, so that no faces are generated there.
+				FillLayer(MIN_int32, 1, EVoxelType::Bedrock);
+
+				// Bedrock layer
+				int32 MinZ, MaxZ;
+				if (Context.ClampAltitudeRange(1, Settings.BedrockThickness, MinZ, MaxZ))
+				{
+					for (int32 Z = MinZ; Z < MaxZ; ++Z)
+					{
+						Grid[ColumnIndex + Z] = BedrockRng.RandRange(0, 100) < 50
+							? EVoxelType::Bedrock
+							: EVoxelType::Stone;
+					}
+				}
+
+				// Stone layer
+				FillLayer(Settings.BedrockThickness, Surface + 1 - Settings.DirtThickness, EVoxelType::Stone);
+
+				// Dirt layer
+				FillLayer(Surface + 1 - Settings.DirtThickness, Surface, EVoxelType::Dirt);
+
+				// Surface
+				EVoxelType SurfaceType;
+				if (Surface < Settings.SeaLevel)
+				{
+					// Below maximum sand depth: dirt, between sea level and maximum sand depth: sand
+					SurfaceType = Surface < Settings.SeaLevel - Settings.SandDepth ? EVoxelType::Dirt : EVoxelType::Sand;
+				}
+				else if (Surface == Settings.SeaLevel)
+				{
+					// Coastal beaches
+					SurfaceType = EVoxelType::Sand;
+				}
+				else
+				{
+					// Fields
+					SurfaceType = EVoxelType::Grass;
+				}
+				FillLayer(Surface, Surface + 1, SurfaceType);
+			}
+		}
+	});
+}
+
+bool FFluidStage::AffectsChunk(const FTerrainGenerationContext& Context) const
+{
+	return Context.MinSurfaceAltitude < Context.Settings.SeaLevel
+		&& Context.ChunkLocation.Z <= Context.Settings.SeaLevel;
+}
+
+void FFluidStage::Execute(FTerrainGenerationContext& Context) const
+{
+	Context.DispatchGrid([&Context](auto Grid)
+	{
+		const int32 SeaLevel = Context.Settings.SeaLevel;
+
+		for (int32 X = 0; X < Grid.PaddedResolution; ++X)
+		{
+			for (int32 Y = 0; Y < Grid.PaddedResolution; ++Y)
+			{
+				const int32 Surface = Context.Heights[Context.GetColumnIndex(X, Y)];
+
+				int32 MinZ, MaxZ;
+				if (Context.ClampAltitudeRange(Surface + 1, SeaLevel + 1, MinZ, MaxZ))
+				{
+					const int32 ColumnIndex = Grid.GetIndex(X, Y, 0);
+					for (int32 Z = MinZ; Z < MaxZ; ++Z)
+					{
+						Grid[ColumnIndex + Z] = EVoxelType::Water;
+					}
+				}
+			}
+		}
+	});
+}
+
+bool FCaveCarverStage::AffectsChunk(const FTerrainGenerationContext& Context) const
+{
+	// Caves are only carved out of the ground, so chunks entirely in the air have nothing to carve.
+	return Context.ChunkLocation.Z <= Context.MaxSurfaceAltitude;
+}
+
+void FCaveCarverStage::Execute(FTerrainGenerationContext& Context) const
+{
+	Context.DispatchGrid([&Context](auto Grid)
+	{
+		const FTerrainGeneratorSettings& Settings = Context.Settings;
+		const FSharedNoiseProvider CaveNoise = GetSharedNoiseProvider(Settings.NoiseAlgorithm, Context.Seed * 13 / 11);
+
+		// Voxels outside of the padded grid are treated as air. Only voxels on the border of the grid need to check
+		// for that, all other neighbours are accessed directly by index.
+		const auto IsFluidChecked = [&Grid](int32 X, int32 Y, int32 Z)
+		{
+			const bool bInside = X >= 0 && X < Grid.PaddedResolution
+				&& Y >= 0 && Y < Grid.PaddedResolution
+				&& Z >= 0 && Z < Grid.PaddedHeight;
+			return bInside && IsVoxelFluid(Grid[Grid.GetIndex(X, Y, Z)]);
+		};
+
+		for (int32 X = 0; X < Grid.PaddedResolution; ++X)
+		{
+			for (int32 Y = 0; Y < Grid.PaddedResolution; ++Y)
+			{
+				const int32 Surface = Context.Heights[Context.GetColumnIndex(X, Y)];
+
+				// Nothing to carve above the surface.
+				int32 MinZ, MaxZ;
+				if (!Context.ClampAltitudeRange(MIN_int32, Surface + 1, MinZ, MaxZ))
+				{
+					continue;
+				}
+
+				const bool bBorderColumn = X == 0 || Y == 0 || X == Grid.PaddedResolution - 1 || Y == Grid.PaddedResolution - 1;
+
+				for (int32 Z = MinZ, Index = Grid.GetIndex(X, Y, MinZ); Z < MaxZ; ++Z, ++Index)
+				{
+					const EVoxelType Voxel = Grid[Index];
+					if (Voxel == EVoxelType::Bedrock || IsVoxelFluid(Voxel))
+					{
+						continue;
+					}
+
+					const double Noise = CaveNoise->GetValue(
+						(FVector(Context.ChunkLocation) + FVector(X, Y, Z)) * Settings.CaveScale);
+					if (Noise < Settings.CaveThreshold)
+					{
+						continue;
+					}
+
+					// Avoid removing solid blocks neighbouring with fluids (except from above).
+					const bool bNextToFluid = (bBorderColumn || Z == Grid.PaddedHeight - 1)
+						? IsFluidChecked(X,     Y,     Z + 1)
+							|| IsFluidChecked(X,     Y + 1, Z    )
+							|| IsFluidChecked(X,     Y - 1, Z    )
+							|| IsFluidChecked(X - 1, Y,     Z    )
+							|| IsFluidChecked(X + 1, Y,     Z    )
+						: IsVoxelFluid(Grid[Index + Grid.StrideZ])
+							|| IsVoxelFluid(Grid[Index + Grid.StrideY])
+							|| IsVoxelFluid(Grid[Index - Grid.StrideY])
+							|| IsVoxelFluid(Grid[Index - Grid.StrideX])
+							|| IsVoxelFluid(Grid[Index + Grid.StrideX]);
+					if (!bNextToFluid)
+					{
+						Grid[Index] = EVoxelType::Air;
+					}
+				}
+			}
+		}
+	});
+}
@@ -0,0 +1,49 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainGenerationPipeline.h"
+
+// Computes the surface altitude of every column using domain-warped noise.
+class FHeightMapStage : public ITerrainGenerationStage
+{
+public:
+	virtual FName GetName() const override { return TEXT("HeightMap"); }
+	virtual ETerrainGenerationData GetInputs() const override { return ETerrainGenerationData::None; }
+	virtual ETerrainGenerationData GetOutputs() const override { return ETerrainGenerationData::Heights; }
+	virtual void Execute(FTerrainGenerationContext& Context) const override;
+};
+
+// Fills columns up to their surface with bedrock, stone, dirt, and a surface block depending on the altitude.
+class FStrataStage : public ITerrainGenerationStage
+{
+public:
+	virtual FName GetName() const override { return TEXT("Strata"); }
+	virtual ETerrainGenerationData GetInputs() const override { return ETerrainGenerationData::Heights; }
+	virtual ETerrainGenerationData GetOutputs() const override { return ETerrainGenerationData::Strata; }
+	virtual bool AffectsChunk(const FTerrainGenerationContext& Context) const override;
+	virtual void Execute(FTerrainGenerationContext& Context) const override;
+};
+
+// Floods columns whose surface lies below the sea level.
+class FFluidStage : public ITerrainGenerationStage
+{
+public:
+	virtual FName GetName() const override { return TEXT("Fluids"); }
+	virtual ETerrainGenerationData GetInputs() const override { return ETerrainGenerationData::Heights; }
+	virtual ETerrainGenerationData GetOutputs() const override { return ETerrainGenerationData::Fluids; }
+	virtual bool AffectsChunk(const FTerrainGenerationContext& Context) const override;
+	virtual void Execute(FTerrainGenerationContext& Context) const override;
+};
+
+// Carves caves out of the terrain using 3D noise, keeping bedrock and the shores of seas intact.
+class FCaveCarverStage : public ITerrainGenerationStage
+{
+public:
+	virtual FName GetName() const override { return TEXT("Caves"); }
+	virtual ETerrainGenerationData GetInputs() const override { return ETerrainGenerationData::Heights | ETerrainGenerationData::Strata | ETerrainGenerationData::Fluids; }
+	virtual ETerrainGenerationData GetOutputs() const override { return ETerrainGenerationData::Carving; }
+	virtual bool AffectsChunk(const FTerrainGenerationContext& Context) const override;
+	virtual void Execute(FTerrainGenerationContext& Context) const override;
+};
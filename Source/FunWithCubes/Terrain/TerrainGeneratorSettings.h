@@ -4,6 +4,20 @@
 
 #include "TerrainGeneratorSettings.generated.h"
 
+// Algorithms available for generating the noise that shapes the terrain.
+UENUM(BlueprintType)
+enum class ENoiseAlgorithm : uint8
+{
+	// Classic Perlin noise. Best quality, slowest.
+	Perlin,
+
+	// OpenSimplex2 noise. Fewer directional artifacts than Perlin noise, and a bit faster.
+	OpenSimplex2,
+
+	// Single precision value noise. Fastest, but produces noticeably blockier terrain.
+	Value,
+};
+
 USTRUCT(BlueprintType)
 struct FTerrainGeneratorSettings
 {
@@ -38,6 +52,11 @@ struct FTerrainGeneratorSettings
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int32 NoiseSeed = 12345;
 
+	// Algorithm used to generate both the height map and the caves. Cheaper algorithms trade terrain quality
+	// for generation throughput.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ENoiseAlgorithm NoiseAlgorithm = ENoiseAlgorithm::Perlin;
+
 	// Scales the sample coordinates for noise used to generate the terrain height map.
 	// Higher values result in a denser distribution of peaks and troughs, whereas
 	// lower values result in a smoother terrain.
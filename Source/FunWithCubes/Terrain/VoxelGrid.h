@@ -0,0 +1,117 @@
+// Made by Adam Gasior (GitHub: Adanos020)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelType.h"
+
+// View over the voxels of a chunk, padded by one voxel on every side so that the neighbours of every non-padding
+// voxel can be accessed without bounds checks. Voxels are stored column by column, i.e. Z is the fastest changing
+// coordinate, followed by Y and X. This is the order in which both the meshing and the generation passes visit
+// voxels, so their inner loops walk memory sequentially.
+//
+// Dimensions are compile-time constants, so strides are multiplications by constants that the compiler can fold
+// into loop increments, and neighbour offsets are immediate values. The padded sizes aren't powers of two, so a full
+// index still takes multiplications. Use `DispatchVoxelGrid` to pick the right instantiation for runtime chunk
+// dimensions.
+template <int32 InResolution, int32 InHeight, typename ElementType = EVoxelType>
+struct TVoxelGrid
+{
+	static constexpr int32 Resolution = InResolution;
+	static constexpr int32 Height = InHeight;
+	static constexpr int32 PaddedResolution = Resolution + 2;
+	static constexpr int32 PaddedHeight = Height + 2;
+	static constexpr int32 StrideZ = 1;
+	static constexpr int32 StrideY = PaddedHeight;
+	static constexpr int32 StrideX = PaddedHeight * PaddedResolution;
+	static constexpr int32 NumVoxels = StrideX * PaddedResolution;
+
+	explicit TVoxelGrid(ElementType* InVoxels)
+		: Voxels(InVoxels)
+	{
+	}
+
+	static constexpr int32 GetIndex(int32 X, int32 Y, int32 Z)
+	{
+		return Z + (Y * StrideY) + (X * StrideX);
+	}
+
+	ElementType& operator[](int32 Index) const { return Voxels[Index]; }
+
+private:
+	ElementType* Voxels;
+};
+
+// Fallback for chunk dimensions which don't have a dedicated `TVoxelGrid` instantiation. Same layout and interface,
+// but dimensions are only known at runtime.
+template <typename ElementType = EVoxelType>
+struct TDynamicVoxelGrid
+{
+	const int32 Resolution;
+	const int32 Height;
+	const int32 PaddedResolution;
+	const int32 PaddedHeight;
+	static constexpr int32 StrideZ = 1;
+	const int32 StrideY;
+	const int32 StrideX;
+	const int32 NumVoxels;
+
+	TDynamicVoxelGrid(ElementType* InVoxels, int32 InResolution, int32 InHeight)
+		: Resolution(InResolution)
+		, Height(InHeight)
+		, PaddedResolution(InResolution + 2)
+		, PaddedHeight(InHeight + 2)
+		, StrideY(PaddedHeight)
+		, StrideX(PaddedHeight * PaddedResolution)
+		, NumVoxels(StrideX * PaddedResolution)
+		, Voxels(InVoxels)
+	{
+	}
+
+	int32 GetIndex(int32 X, int32 Y, int32 Z) const
+	{
+		return Z + (Y * StrideY) + (X * StrideX);
+	}
+
+	ElementType& operator[](int32 Index) const { return Voxels[Index]; }
+
+private:
+	ElementType* Voxels;
+};
+
+// Returns the number of voxels, including padding, in a chunk of the given dimensions.
+constexpr int32 GetNumPaddedVoxels(int32 Resolution, int32 Height)
+{
+	return (Resolution + 2) * (Resolution + 2) * (Height + 2);
+}
+
+namespace VoxelGridPrivate
+{
+	template <int32 Resolution, typename ElementType, typename FunctorType>
+	void DispatchHeight(ElementType* Voxels, int32 Height, FunctorType&& Functor)
+	{
+		switch (Height)
+		{
+		case 16:  Functor(TVoxelGrid<Resolution, 16,  ElementType>(Voxels)); return;
+		case 32:  Functor(TVoxelGrid<Resolution, 32,  ElementType>(Voxels)); return;
+		case 64:  Functor(TVoxelGrid<Resolution, 64,  ElementType>(Voxels)); return;
+		case 128: Functor(TVoxelGrid<Resolution, 128, ElementType>(Voxels)); return;
+		case 256: Functor(TVoxelGrid<Resolution, 256, ElementType>(Voxels)); return;
+		default:  Functor(TDynamicVoxelGrid<ElementType>(Voxels, Resolution, Height)); return;
+		}
+	}
+}
+
+// Calls `Functor` with a grid over `Voxels` specialised for the given chunk dimensions, or with the dynamic grid
+// if there's no specialisation for them. `Voxels` has to contain exactly `GetNumPaddedVoxels` elements.
+template <typename ElementType, typename FunctorType>
+void DispatchVoxelGrid(ElementType* Voxels, int32 Resolution, int32 Height, FunctorType&& Functor)
+{
+	switch (Resolution)
+	{
+	case 16: VoxelGridPrivate::DispatchHeight<16>(Voxels, Height, Functor); return;
+	case 32: VoxelGridPrivate::DispatchHeight<32>(Voxels, Height, Functor); return;
+	case 64: VoxelGridPrivate::DispatchHeight<64>(Voxels, Height, Functor); return;
+	default: Functor(TDynamicVoxelGrid<ElementType>(Voxels, Resolution, Height)); return;
+	}
+}
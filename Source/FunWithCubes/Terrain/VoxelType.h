@@ -14,6 +14,85 @@ enum class EVoxelType : uint8
 	Sand,
 	Stone,
 	Water,
+
+	Count UMETA(Hidden),
+};
+
+constexpr int32 NumVoxelTypes = static_cast<int32>(EVoxelType::Count);
+
+// Mesh section into which faces of a given voxel type are put. Each section has its own material.
+enum class EVoxelMeshSection : int8
+{
+	None = -1,
+	Terrain,
+	Water,
+
+	Count,
+};
+
+constexpr int32 NumVoxelMeshSections = static_cast<int32>(EVoxelMeshSection::Count);
+
+struct FVoxelProperties
+{
+	// Whether the voxel blocks movement and hides faces of fluids next to it.
+	bool bSolid;
+
+	// Whether faces of solid voxels next to this one are visible.
+	bool bTransparent;
+
+	// Whether the voxel is a liquid. Fluid faces are only generated against transparent non-fluid voxels, and the
+	// top face of a fluid column is slightly lowered.
+	bool bFluid;
+
+	EVoxelMeshSection MeshSection;
+};
+
+// Properties of each voxel type, indexed by `EVoxelType`. Adding a new voxel type only requires adding a row here.
+inline constexpr FVoxelProperties GVoxelProperties[] = {
+	//           bSolid  bTransparent  bFluid  MeshSection
+	/* Air     */ { false, true,         false,  EVoxelMeshSection::None    },
+	/* Bedrock */ { true,  false,        false,  EVoxelMeshSection::Terrain },
+	/* Dirt    */ { true,  false,        false,  EVoxelMeshSection::Terrain },
+	/* Grass   */ { true,  false,        false,  EVoxelMeshSection::Terrain },
+	/* Sand    */ { true,  false,        false,  EVoxelMeshSection::Terrain },
+	/* Stone   */ { true,  false,        false,  EVoxelMeshSection::Terrain },
+	/* Water   */ { false, true,         true,   EVoxelMeshSection::Water   },
 };
 
-bool IsVoxelSolid(EVoxelType VoxelType);
+static_assert(UE_ARRAY_COUNT(GVoxelProperties) == NumVoxelTypes, "Every voxel type needs an entry in GVoxelProperties.");
+
+FORCEINLINE constexpr const FVoxelProperties& GetVoxelProperties(EVoxelType VoxelType)
+{
+	return GVoxelProperties[static_cast<uint8>(VoxelType)];
+}
+
+FORCEINLINE constexpr bool IsVoxelSolid(EVoxelType VoxelType)
+{
+	return GetVoxelProperties(VoxelType).bSolid;
+}
+
+FORCEINLINE constexpr bool IsVoxelTransparent(EVoxelType VoxelType)
+{
+	return GetVoxelProperties(VoxelType).bTransparent;
+}
+
+FORCEINLINE constexpr bool IsVoxelFluid(EVoxelType VoxelType)
+{
+	return GetVoxelProperties(VoxelType).bFluid;
+}
+
+// Whether the face of a voxel with the given properties is visible if it's next to `Neighbour`. Specialised on the
+// properties of the voxel itself, so that meshing loops only ever look up the neighbour in the table.
+template <bool bFluid>
+FORCEINLINE constexpr bool IsVoxelFaceVisible(EVoxelType Neighbour)
+{
+	const FVoxelProperties& NeighbourProperties = GetVoxelProperties(Neighbour);
+	if constexpr (bFluid)
+	{
+		return NeighbourProperties.bTransparent && !NeighbourProperties.bFluid;
+	}
+	else
+	{
+		return NeighbourProperties.bTransparent;
+	}
+}